@@ -0,0 +1,80 @@
+// arena.c - Bump allocator released all at once
+//
+// Blocks are carved from large chunks in the order they are asked for,
+// so what is built together sits together in memory. Each block is
+// zeroed as it is handed out, leaving the unused end of a chunk
+// untouched. Nothing is freed on its own: arena_free releases every
+// chunk at once.
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+// Blocks start on multiples of this
+#define ARENA_ALIGN 8
+#define ARENA_ROUND(n) (((n) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+struct ArenaChunk {
+    ArenaChunk *prev;
+    size_t size;        // Bytes of blocks after the header
+};
+
+#define CHUNK_HEADER ARENA_ROUND(sizeof(ArenaChunk))
+
+static ArenaChunk* chunk_new(ArenaChunk *prev, size_t size) {
+    ArenaChunk *chunk = malloc(CHUNK_HEADER + size);
+    if (!chunk) return NULL;
+    chunk->prev = prev;
+    chunk->size = size;
+    return chunk;
+}
+
+Arena* arena_new(size_t size) {
+    size_t self = ARENA_ROUND(sizeof(Arena));
+    ArenaChunk *chunk = chunk_new(NULL, self + ARENA_ROUND(size));
+    if (!chunk) return NULL;
+    
+    Arena *arena = (Arena*)((char*)chunk + CHUNK_HEADER);
+    memset(arena, 0, sizeof(Arena));
+    arena->chunk = chunk;
+    arena->used = self;
+    return arena;
+}
+
+void arena_free(Arena *arena) {
+    if (!arena) return;
+    
+    // The arena itself is in the first chunk, freed last
+    ArenaChunk *chunk = arena->chunk;
+    while (chunk) {
+        ArenaChunk *prev = chunk->prev;
+        free(chunk);
+        chunk = prev;
+    }
+}
+
+void* arena_alloc(Arena *arena, size_t size) {
+    size = ARENA_ROUND(size ? size : 1);
+    
+    if (arena->used + size > arena->chunk->size) {
+        size_t chunk_size = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+        ArenaChunk *chunk = chunk_new(arena->chunk, chunk_size);
+        if (!chunk) return NULL;
+        arena->chunk = chunk;
+        arena->used = 0;
+    }
+    
+    void *block = (char*)arena->chunk + CHUNK_HEADER + arena->used;
+    arena->used += size;
+    memset(block, 0, size);
+    return block;
+}
+
+char* arena_strndup(Arena *arena, const char *s, size_t len) {
+    char *copy = arena_alloc(arena, len + 1);
+    if (copy) memcpy(copy, s, len);
+    return copy;
+}
+
+char* arena_strdup(Arena *arena, const char *s) {
+    return arena_strndup(arena, s, strlen(s));
+}
@@ -0,0 +1,27 @@
+// arena.h - Bump allocator released all at once
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Space for chunks after the first, unless a larger block is asked for
+#define ARENA_CHUNK_SIZE 16384
+
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct {
+    ArenaChunk *chunk;  // Chunk being filled; earlier ones hang off it
+    size_t used;        // Bytes handed out from it
+} Arena;
+
+// The arena lives at the start of its own first chunk, which has room
+// for size bytes of blocks
+Arena* arena_new(size_t size);
+void arena_free(Arena *arena);
+
+// Zeroed and aligned for any of the puzzle's types; never freed alone
+void* arena_alloc(Arena *arena, size_t size);
+char* arena_strdup(Arena *arena, const char *s);
+char* arena_strndup(Arena *arena, const char *s, size_t len);
+
+#endif // ARENA_H
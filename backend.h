@@ -0,0 +1,52 @@
+// backend.h - Terminal backends behind the screen layer
+#ifndef BACKEND_H
+#define BACKEND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Returned by read_key when the timeout expires without input, or when
+// wake was called while it waited
+#define BACKEND_TIMEOUT -2
+#define BACKEND_WAKE -3
+
+// A backend owns the terminal: it sets it up, reports its size, takes
+// whole frames of escape-encoded UTF-8 output and decodes keys. wake may
+// be called from any thread to cut a read_key wait short; it is NULL for
+// backends that never block.
+typedef struct {
+    const char *name;
+    bool (*init)(void);
+    void (*shutdown)(void);
+    void (*get_size)(int *lines, int *cols);
+    void (*write)(const char *buf, size_t len);
+    int (*read_key)(int timeout_ms); // timeout_ms < 0 blocks; -1 on resize
+    void (*wake)(void);
+} ScreenBackend;
+
+#ifdef _WIN32
+extern const ScreenBackend backend_win32;
+#else
+extern const ScreenBackend backend_posix;
+#endif
+extern const ScreenBackend backend_headless;
+extern const ScreenBackend backend_replay;  // session.c
+
+// Headless backend counters
+typedef struct {
+    unsigned long writes;      // Calls to write, i.e. flushes
+    unsigned long long bytes;  // Bytes written
+    unsigned long escapes;     // Escape sequences interpreted
+    unsigned long glyphs;      // Characters drawn
+    unsigned long keys;        // Bytes of input consumed
+} HeadlessStats;
+
+void headless_get_stats(HeadlessStats *stats);
+void headless_dump(FILE *fp);
+
+// Size the next headless init uses over CLIPTIC_HEADLESS_SIZE; 0, 0 to
+// go back to it
+void headless_set_size(int lines, int cols);
+
+#endif // BACKEND_H
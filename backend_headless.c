@@ -0,0 +1,271 @@
+// backend_headless.c - In-memory backend for tests and benchmarks
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "backend.h"
+#include "input.h"
+#include "utf8.h"
+
+#define HEADLESS_LINES 40
+#define HEADLESS_COLS 80
+
+// Largest size CLIPTIC_HEADLESS_SIZE may ask for, either way
+#define HEADLESS_MAX_SIZE 1000
+
+// One emulated terminal cell
+typedef struct {
+    unsigned int ch;
+    int fg;
+    int bg;
+    bool underline;
+} HeadlessCell;
+
+static HeadlessCell *fb;
+static int fb_lines;
+static int fb_cols;
+static HeadlessStats hstats;
+
+// Emulated terminal state
+static int term_y;
+static int term_x;
+static int sgr_fg = 39;
+static int sgr_bg = 49;
+static bool sgr_underline;
+
+// Parser state for the escape and UTF-8 stream
+static enum { ST_GROUND, ST_ESC, ST_CSI } state;
+static char csi[32];
+static int csi_len;
+static unsigned int utf8_ch;
+static int utf8_left;
+
+static void fb_clear(void) {
+    for (int i = 0; i < fb_lines * fb_cols; i++) {
+        fb[i].ch = ' ';
+        fb[i].fg = 39;
+        fb[i].bg = 49;
+        fb[i].underline = false;
+    }
+}
+
+static bool headless_size_ok(int lines, int cols) {
+    return lines >= 1 && lines <= HEADLESS_MAX_SIZE &&
+           cols >= 1 && cols <= HEADLESS_MAX_SIZE;
+}
+
+// Size set by headless_set_size, 0 for none
+static int set_lines;
+static int set_cols;
+
+void headless_set_size(int lines, int cols) {
+    set_lines = lines;
+    set_cols = cols;
+}
+
+static bool headless_init(void) {
+    // A size set by the caller, else CLIPTIC_HEADLESS_SIZE as LINESxCOLS;
+    // anything unreadable or out of range keeps the default
+    const char *size = getenv("CLIPTIC_HEADLESS_SIZE");
+    int lines, cols;
+    fb_lines = HEADLESS_LINES;
+    fb_cols = HEADLESS_COLS;
+    if (headless_size_ok(set_lines, set_cols)) {
+        fb_lines = set_lines;
+        fb_cols = set_cols;
+    } else if (size && sscanf(size, "%dx%d", &lines, &cols) == 2 &&
+               headless_size_ok(lines, cols)) {
+        fb_lines = lines;
+        fb_cols = cols;
+    }
+    
+    fb = malloc(fb_lines * fb_cols * sizeof(HeadlessCell));
+    if (!fb) return false;
+    fb_clear();
+    memset(&hstats, 0, sizeof(hstats));
+    input_reset();
+    return true;
+}
+
+static void headless_shutdown(void) {
+    const char *path = getenv("CLIPTIC_HEADLESS_DUMP");
+    FILE *fp = path ? fopen(path, "w") : stderr;
+    if (fp) {
+        headless_dump(fp);
+        if (fp != stderr) fclose(fp);
+    }
+    free(fb);
+    fb = NULL;
+}
+
+static void headless_get_size(int *lines, int *cols) {
+    *lines = fb_lines;
+    *cols = fb_cols;
+}
+
+// Wide glyphs cover the next cell too, marked with ch 0
+static void put_glyph(unsigned int ch) {
+    int width = utf8_cp_width(ch) == 2 ? 2 : 1;
+    hstats.glyphs++;
+    for (int i = 0; i < width; i++) {
+        if (term_y >= 0 && term_y < fb_lines && term_x >= 0 && term_x < fb_cols) {
+            HeadlessCell *cell = &fb[term_y * fb_cols + term_x];
+            cell->ch = i == 0 ? ch : 0;
+            cell->fg = sgr_fg;
+            cell->bg = sgr_bg;
+            cell->underline = sgr_underline;
+        }
+        if (term_x < fb_cols - 1) term_x++;
+    }
+}
+
+static int clamp(int v, int min, int max) {
+    if (v < min) return min;
+    if (v > max) return max;
+    return v;
+}
+
+static void apply_sgr(const char *params) {
+    const char *p = params;
+    if (!*p) {
+        sgr_fg = 39; sgr_bg = 49; sgr_underline = false;
+        return;
+    }
+    while (*p) {
+        int n = atoi(p);
+        if (n == 0) { sgr_fg = 39; sgr_bg = 49; sgr_underline = false; }
+        else if (n == 4) sgr_underline = true;
+        else if (n == 24) sgr_underline = false;
+        else if ((n >= 30 && n <= 39) || (n >= 90 && n <= 97)) sgr_fg = n;
+        else if ((n >= 40 && n <= 49) || (n >= 100 && n <= 107)) sgr_bg = n;
+        
+        p = strchr(p, ';');
+        if (!p) break;
+        p++;
+    }
+}
+
+// Execute a complete CSI sequence: params in csi, final byte in final
+static void apply_csi(char final) {
+    int a = 0, b = 0;
+    csi[csi_len] = '\0';
+    
+    if (csi[0] == '?') return; // Private modes (cursor, sync, screen)
+    sscanf(csi, "%d;%d", &a, &b);
+    int n = a > 0 ? a : 1;
+    
+    switch (final) {
+        case 'H': term_y = (a > 0 ? a : 1) - 1; term_x = (b > 0 ? b : 1) - 1; break;
+        case 'A': term_y -= n; break;
+        case 'B': term_y += n; break;
+        case 'C': term_x += n; break;
+        case 'D': term_x -= n; break;
+        case 'G': term_x = n - 1; break;
+        case 'J': if (a == 2) fb_clear(); break;
+        case 'm': apply_sgr(csi); break;
+    }
+    term_y = clamp(term_y, 0, fb_lines - 1);
+    term_x = clamp(term_x, 0, fb_cols - 1);
+}
+
+static void headless_write(const char *buf, size_t len) {
+    hstats.writes++;
+    hstats.bytes += len;
+    
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)buf[i];
+        
+        switch (state) {
+            case ST_ESC:
+                if (c == '[') {
+                    state = ST_CSI;
+                    csi_len = 0;
+                } else {
+                    state = ST_GROUND;
+                }
+                continue;
+            case ST_CSI:
+                if (c >= 0x40 && c <= 0x7E) {
+                    apply_csi((char)c);
+                    hstats.escapes++;
+                    state = ST_GROUND;
+                } else if (csi_len < (int)sizeof(csi) - 1) {
+                    csi[csi_len++] = (char)c;
+                }
+                continue;
+            case ST_GROUND:
+                break;
+        }
+        
+        if (utf8_left > 0 && (c & 0xC0) == 0x80) {
+            utf8_ch = (utf8_ch << 6) | (c & 0x3F);
+            if (--utf8_left == 0) put_glyph(utf8_ch);
+        } else if (c == 0x1b) {
+            state = ST_ESC;
+        } else if (c == '\r') {
+            term_x = 0;
+        } else if (c == '\n') {
+            if (term_y < fb_lines - 1) term_y++;
+        } else if (c >= 0xF0) {
+            utf8_ch = c & 0x07; utf8_left = 3;
+        } else if (c >= 0xE0) {
+            utf8_ch = c & 0x0F; utf8_left = 2;
+        } else if (c >= 0xC0) {
+            utf8_ch = c & 0x1F; utf8_left = 1;
+        } else if (c >= 0x20) {
+            put_glyph(c);
+        }
+    }
+}
+
+// Keys come from stdin through the shared decoder; stdio already reads
+// it in blocks. End of input reads as Ctrl+C so sessions wind down.
+static int headless_read_key(int timeout_ms) {
+    (void)timeout_ms;
+    
+    InputEvent ev;
+    while (!input_next(&ev)) {
+        int c = fgetc(stdin);
+        if (c == EOF) {
+            input_flush();
+            if (input_next(&ev)) break;
+            return 3;
+        }
+        hstats.keys++;
+        
+        char byte = (char)c;
+        input_feed(&byte, 1);
+    }
+    return ev.key;
+}
+
+void headless_get_stats(HeadlessStats *out) {
+    *out = hstats;
+}
+
+// Write the emulated screen as text, then the counters
+void headless_dump(FILE *fp) {
+    char line[4096];
+    
+    for (int y = 0; y < fb_lines; y++) {
+        int len = 0;
+        for (int x = 0; x < fb_cols && len < (int)sizeof(line) - 5; x++) {
+            unsigned int c = fb[y * fb_cols + x].ch;
+            if (c != 0) len += utf8_encode(c, &line[len]);
+        }
+        while (len > 0 && line[len - 1] == ' ') len--;
+        fprintf(fp, "%.*s\n", len, line);
+    }
+    
+    fprintf(fp, "-- writes %lu, bytes %llu, escapes %lu, glyphs %lu, keys %lu\n",
+            hstats.writes, hstats.bytes, hstats.escapes, hstats.glyphs, hstats.keys);
+}
+
+const ScreenBackend backend_headless = {
+    "headless",
+    headless_init,
+    headless_shutdown,
+    headless_get_size,
+    headless_write,
+    headless_read_key,
+    NULL
+};
@@ -0,0 +1,190 @@
+// backend_posix.c - POSIX terminal backend (termios + ANSI)
+#ifndef _WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "backend.h"
+#include "input.h"
+
+#define ESC_TIMEOUT_MS 25
+#define POSIX_READ_SIZE 4096
+
+static struct termios original_termios;
+static bool raw_enabled;
+static volatile sig_atomic_t resized;
+
+// Self-pipe polled next to stdin: written by wake and by the SIGWINCH
+// handler, so a wait ends on a resize or posted work whichever thread
+// the signal lands on
+static int wake_pipe[2] = { -1, -1 };
+
+static void posix_write_all(const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(STDOUT_FILENO, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        buf += n;
+        len -= n;
+    }
+}
+
+static void posix_wake(void) {
+    if (wake_pipe[1] < 0) return;
+    int saved = errno;
+    char c = 0;
+    ssize_t n = write(wake_pipe[1], &c, 1); // Full pipe: already woken
+    (void)n;
+    errno = saved;
+}
+
+static void posix_on_winch(int sig) {
+    (void)sig;
+    resized = 1;
+    posix_wake();
+}
+
+static void posix_drain_wake(void) {
+    char buf[64];
+    while (read(wake_pipe[0], buf, sizeof(buf)) > 0) {}
+}
+
+static bool posix_init(void) {
+    if (tcgetattr(STDIN_FILENO, &original_termios) != 0) return false;
+    
+    // Raw mode: no echo, no line buffering, no signal keys, no CR mapping
+    struct termios raw = original_termios;
+    raw.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+    raw.c_oflag &= ~(OPOST);
+    raw.c_cflag |= CS8;
+    raw.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) != 0) return false;
+    raw_enabled = true;
+    
+    if (pipe(wake_pipe) == 0) {
+        for (int i = 0; i < 2; i++) {
+            fcntl(wake_pipe[i], F_SETFL, fcntl(wake_pipe[i], F_GETFL) | O_NONBLOCK);
+            fcntl(wake_pipe[i], F_SETFD, FD_CLOEXEC);
+        }
+    } else {
+        wake_pipe[0] = wake_pipe[1] = -1;
+    }
+    
+    // No SA_RESTART so a resize interrupts poll() in read_key
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = posix_on_winch;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGWINCH, &sa, NULL);
+    
+    input_reset();
+    
+    // Alternate screen, cleared once on entry, with bracketed paste
+    static const char enter[] = "\x1b[?1049h\x1b[H\x1b[2J\x1b[?2004h";
+    posix_write_all(enter, sizeof(enter) - 1);
+    return true;
+}
+
+static void posix_shutdown(void) {
+    if (!raw_enabled) return;
+    
+    static const char leave[] = "\x1b[?2004l\x1b[0m\x1b[?25h\x1b[?1049l";
+    posix_write_all(leave, sizeof(leave) - 1);
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &original_termios);
+    raw_enabled = false;
+    
+    if (wake_pipe[0] >= 0) {
+        close(wake_pipe[0]);
+        close(wake_pipe[1]);
+        wake_pipe[0] = wake_pipe[1] = -1;
+    }
+}
+
+static void posix_get_size(int *lines, int *cols) {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0) {
+        *lines = ws.ws_row;
+        *cols = ws.ws_col;
+    } else {
+        *lines = 24;
+        *cols = 80;
+    }
+}
+
+// Wait for input and feed everything available to the decoder in one
+// read. Returns 0 once bytes were fed, BACKEND_TIMEOUT or -1 on resize, or
+// BACKEND_WAKE if wakeable and wake was called. The rest of an escape
+// sequence is read without watching the wake pipe, so a wake is left
+// pending rather than splitting the sequence.
+static int posix_fill(int timeout_ms, bool wakeable) {
+    struct pollfd pfd[2] = {
+        { STDIN_FILENO, POLLIN, 0 },
+        { wake_pipe[0], POLLIN, 0 }
+    };
+    int nfds = (wakeable && wake_pipe[0] >= 0) ? 2 : 1;
+    
+    while (1) {
+        if (resized) {
+            resized = 0;
+            return -1;
+        }
+        
+        int ready = poll(pfd, nfds, timeout_ms);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return BACKEND_TIMEOUT;
+        }
+        if (ready == 0) return BACKEND_TIMEOUT;
+        
+        if (nfds == 2 && (pfd[1].revents & POLLIN)) {
+            posix_drain_wake();
+            if (resized) continue;
+            return BACKEND_WAKE;
+        }
+        
+        char buf[POSIX_READ_SIZE];
+        ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+        if (n > 0) {
+            input_feed(buf, (size_t)n);
+            return 0;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        return BACKEND_TIMEOUT;
+    }
+}
+
+// Keys left over from an earlier read are returned without a syscall
+static int posix_read_key(int timeout_ms) {
+    InputEvent ev;
+    while (!input_next(&ev)) {
+        bool partial = input_partial();
+        int r = posix_fill(partial ? ESC_TIMEOUT_MS : timeout_ms, !partial);
+        if (r == BACKEND_TIMEOUT && partial) {
+            input_flush(); // A lone ESC
+            continue;
+        }
+        if (r < 0) return r;
+    }
+    return ev.key;
+}
+
+const ScreenBackend backend_posix = {
+    "posix",
+    posix_init,
+    posix_shutdown,
+    posix_get_size,
+    posix_write_all,
+    posix_read_key,
+    posix_wake
+};
+
+#endif // _WIN32
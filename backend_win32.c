@@ -0,0 +1,191 @@
+// backend_win32.c - Win32 console backend
+#ifdef _WIN32
+
+#include <windows.h>
+#include "backend.h"
+#include "input.h"
+#include "utf8.h"
+
+#define ESC_TIMEOUT_MS 25
+#define WIN32_READ_RECORDS 128
+
+static HANDLE hConsoleOut;
+static HANDLE hConsoleIn;
+static DWORD originalInMode;
+static DWORD originalOutMode;
+static HANDLE hWake; // Auto-reset event set by win32_wake
+static WCHAR high_surrogate;
+
+static void win32_write(const char *buf, size_t len) {
+    DWORD written;
+    WriteFile(hConsoleOut, buf, (DWORD)len, &written, NULL);
+}
+
+static bool win32_init(void) {
+    // Get console handles
+    hConsoleOut = GetStdHandle(STD_OUTPUT_HANDLE);
+    hConsoleIn = GetStdHandle(STD_INPUT_HANDLE);
+    
+    // Set console mode
+    DWORD mode;
+    GetConsoleMode(hConsoleIn, &mode);
+    originalInMode = mode;
+    mode &= ~ENABLE_ECHO_INPUT;
+    mode &= ~ENABLE_LINE_INPUT;
+    mode |= ENABLE_VIRTUAL_TERMINAL_INPUT;
+    mode |= ENABLE_WINDOW_INPUT; // Report resizes as input records
+    SetConsoleMode(hConsoleIn, mode);
+    
+    hWake = CreateEventA(NULL, FALSE, FALSE, NULL);
+    input_reset();
+    
+    // Enable virtual terminal processing for output
+    GetConsoleMode(hConsoleOut, &mode);
+    originalOutMode = mode;
+    mode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+    if (!SetConsoleMode(hConsoleOut, mode)) return false;
+    
+    // Bracketed paste, so a paste arrives as one KEY_PASTE
+    static const char enter[] = "\x1b[?2004h";
+    win32_write(enter, sizeof(enter) - 1);
+    return true;
+}
+
+static void win32_shutdown(void) {
+    static const char leave[] = "\x1b[?2004l";
+    win32_write(leave, sizeof(leave) - 1);
+    SetConsoleMode(hConsoleIn, originalInMode);
+    SetConsoleMode(hConsoleOut, originalOutMode);
+    if (hWake) {
+        CloseHandle(hWake);
+        hWake = NULL;
+    }
+}
+
+static void win32_wake(void) {
+    if (hWake) SetEvent(hWake);
+}
+
+static void win32_get_size(int *lines, int *cols) {
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    GetConsoleScreenBufferInfo(hConsoleOut, &csbi);
+    *cols = csbi.srWindow.Right - csbi.srWindow.Left + 1;
+    *lines = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+}
+
+// Keys without a character, for consoles that do not send VT sequences
+static int win32_vk_key(WORD vk) {
+    switch (vk) {
+        case VK_UP:     return 259;
+        case VK_DOWN:   return 258;
+        case VK_LEFT:   return 260;
+        case VK_RIGHT:  return 261;
+        case VK_HOME:   return KEY_HOME;
+        case VK_END:    return KEY_END;
+        case VK_DELETE: return KEY_DELETE;
+        case VK_PRIOR:  return KEY_PAGE_UP;
+        case VK_NEXT:   return KEY_PAGE_DOWN;
+    }
+    return 0;
+}
+
+// Take every pending input record in one call. Characters, including the
+// VT sequences the console sends for special keys and pastes, are fed to
+// the decoder as UTF-8; resizes are queued as -1.
+static void win32_fill(void) {
+    INPUT_RECORD records[WIN32_READ_RECORDS];
+    DWORD count = 0;
+    if (!ReadConsoleInputW(hConsoleIn, records, WIN32_READ_RECORDS, &count)) return;
+    
+    char buf[WIN32_READ_RECORDS * 4];
+    size_t len = 0;
+    
+    for (DWORD i = 0; i < count; i++) {
+        if (records[i].EventType == WINDOW_BUFFER_SIZE_EVENT) {
+            input_feed(buf, len);
+            len = 0;
+            input_push(-1); // Special code for resize
+            continue;
+        }
+        if (records[i].EventType != KEY_EVENT) continue;
+        
+        KEY_EVENT_RECORD *key = &records[i].Event.KeyEvent;
+        if (!key->bKeyDown) continue;
+        WCHAR wc = key->uChar.UnicodeChar;
+        
+        if (wc == 0) {
+            int special = win32_vk_key(key->wVirtualKeyCode);
+            if (special) {
+                input_feed(buf, len);
+                len = 0;
+                input_push(special);
+            }
+            continue;
+        }
+        
+        // Join surrogate pairs before encoding
+        unsigned int cp = wc;
+        if (wc >= 0xD800 && wc <= 0xDBFF) {
+            high_surrogate = wc;
+            continue;
+        }
+        if (wc >= 0xDC00 && wc <= 0xDFFF) {
+            if (!high_surrogate) continue;
+            cp = 0x10000 + ((high_surrogate - 0xD800) << 10) + (wc - 0xDC00);
+        }
+        high_surrogate = 0;
+        
+        if (len + 4 > sizeof(buf)) {
+            input_feed(buf, len);
+            len = 0;
+        }
+        len += utf8_encode(cp, &buf[len]);
+    }
+    input_feed(buf, len);
+}
+
+// Keys left over from an earlier read are returned without waiting
+static int win32_read_key(int timeout_ms) {
+    InputEvent ev;
+    DWORD start = GetTickCount();
+    
+    HANDLE handles[2] = { hConsoleIn, hWake };
+    
+    while (!input_next(&ev)) {
+        // Wait on the console and the wake event together, so posted
+        // work ends the wait as promptly as a key does. The rest of an
+        // escape sequence is waited for briefly and without the wake.
+        bool partial = input_partial();
+        DWORD wait = INFINITE;
+        if (partial) {
+            wait = ESC_TIMEOUT_MS;
+        } else if (timeout_ms >= 0) {
+            DWORD elapsed = GetTickCount() - start;
+            wait = elapsed < (DWORD)timeout_ms ? timeout_ms - elapsed : 0;
+        }
+        DWORD ready = WaitForMultipleObjects((hWake && !partial) ? 2 : 1, handles, FALSE, wait);
+        if (ready == WAIT_OBJECT_0) {
+            win32_fill();
+            continue;
+        }
+        if (partial) {
+            input_flush(); // A lone ESC
+            continue;
+        }
+        if (ready == WAIT_OBJECT_0 + 1) return BACKEND_WAKE;
+        return BACKEND_TIMEOUT;
+    }
+    return ev.key;
+}
+
+const ScreenBackend backend_win32 = {
+    "win32",
+    win32_init,
+    win32_shutdown,
+    win32_get_size,
+    win32_write,
+    win32_read_key,
+    win32_wake
+};
+
+#endif // _WIN32
@@ -0,0 +1,338 @@
+// bench.c - Rendering benchmarks against the headless backend
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "cliptic.h"
+#include "screen.h"
+#include "backend.h"
+#include "config.h"
+#include "game.h"
+#include "latency.h"
+
+#define BENCH_SQUARES 15
+#define BENCH_SETUP_RUNS 50
+#define BENCH_TYPING_RUNS 3
+#define BENCH_TAB_PRESSES 200
+#define BENCH_REDRAW_RUNS 100
+#define BENCH_CLUE_LAPS 5
+#define BENCH_PARSE_RUNS 500
+#define BENCH_PAYLOAD_SIZE 65536
+
+// Timings and output of one scenario
+typedef struct BenchScenario BenchScenario;
+struct BenchScenario {
+    const char *name;
+    void (*run)(BenchScenario *s);
+    unsigned long long *samples; // Wall time per operation (us)
+    int count;
+    int cap;
+    unsigned long long bytes;
+    unsigned long writes;
+    HeadlessStats start_stats;   // Operation in progress
+    unsigned long long start_us;
+};
+
+// Hints of mixed length, some long enough to wrap and some non-ASCII
+static const char *bench_hints[] = {
+    "Ship's officer returns to base",
+    "Trouble at the old mill, one hears, after a long and winding "
+        "journey through the valley of the cryptic setter's imagination",
+    "Caf\xc3\xa9 owner's r\xc3\xa9sum\xc3\xa9, na\xc3\xafvely translated",
+    "Small drink",
+    "Piano keys struck in anger by a rattled conductor with a grudge",
+    "Fish in the river, briefly",
+    "Capital of \xe6\x9d\xb1\xe4\xba\xac prefecture, going west",
+    "Note the first of many"
+};
+#define BENCH_HINT_COUNT (int)(sizeof(bench_hints) / sizeof(bench_hints[0]))
+
+static char bench_letter(int y, int x) {
+    return 'A' + (y * 7 + x * 3) % 26;
+}
+
+// Letters wherever the row or the column is even: an across clue on
+// every even row and a down clue on every even column
+static Puzzle* bench_puzzle_new(void) {
+    int n = BENCH_SQUARES;
+    int count = 2 * ((n + 1) / 2);
+    Clue **clues = calloc(count, sizeof(Clue*));
+    char answer[BENCH_SQUARES + 1];
+    int c = 0;
+    
+    answer[n] = '\0';
+    for (int i = 0; i < n; i += 2) {
+        for (int j = 0; j < n; j++) answer[j] = bench_letter(i, j);
+        clues[c] = clue_new(answer, bench_hints[c % BENCH_HINT_COUNT],
+                            DIR_ACROSS, pos_make(i, 0));
+        c++;
+        
+        for (int j = 0; j < n; j++) answer[j] = bench_letter(j, i);
+        clues[c] = clue_new(answer, bench_hints[c % BENCH_HINT_COUNT],
+                            DIR_DOWN, pos_make(0, i));
+        c++;
+    }
+    
+    return puzzle_new_from_clues(pos_make(n, n), clues, count);
+}
+
+// Append s form-encoded, as the server sends hints
+static size_t bench_form_encode(char *buf, size_t len, size_t size, const char *s) {
+    static const char hex[] = "0123456789ABCDEF";
+    for (; *s && len + 4 < size; s++) {
+        unsigned char c = (unsigned char)*s;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+            (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.') {
+            buf[len++] = c;
+        } else if (c == ' ') {
+            buf[len++] = '+';
+        } else {
+            buf[len++] = '%';
+            buf[len++] = hex[c >> 4];
+            buf[len++] = hex[c & 15];
+        }
+    }
+    return len;
+}
+
+// The bench puzzle as a payload for parse_puzzle_data, in the server's
+// JSON envelope
+static size_t bench_payload_new(char *buf, size_t size) {
+    Puzzle *puzzle = bench_puzzle_new();
+    size_t len = snprintf(buf, size, "{\"cells\": [{\"meta\": {\"data\": "
+                          "\"title=Bench&rows=%d&columns=%d",
+                          puzzle->size.y, puzzle->size.x);
+    
+    for (int i = 0; i < puzzle->clue_count && len < size; i++) {
+        Clue *clue = puzzle->clues[i];
+        len += snprintf(buf + len, size - len, "&word%d=%s&clue%d=", i, clue->answer, i);
+        len = bench_form_encode(buf, len, size, clue->hint);
+        len += snprintf(buf + len, size - len, "&dir%d=%s&start_j%d=%d&start_k%d=%d",
+                        i, clue->dir == DIR_ACROSS ? "a" : "d",
+                        i, clue->start.x, i, clue->start.y);
+    }
+    len += snprintf(buf + len, size - len, "\"}}]}\n");
+    
+    puzzle_free(puzzle);
+    return len;
+}
+
+static Game* bench_game_new(void) {
+    GameState *state = calloc(1, sizeof(GameState));
+    state->date = date_today();
+    return game_new_with(state->date, bench_puzzle_new(), state);
+}
+
+// Draw the game the way game_play does before its loop
+static void bench_game_setup(Game *game) {
+    top_bar_draw(game->top_bar);
+    bottom_bar_draw(game->bottom_bar);
+    bottom_bar_mode(game->bottom_bar, game->mode);
+    board_setup(&game->board, game->state);
+}
+
+static void bench_begin(BenchScenario *s) {
+    headless_get_stats(&s->start_stats);
+    s->start_us = clock_now_us();
+}
+
+static void bench_end(BenchScenario *s) {
+    unsigned long long us = clock_now_us() - s->start_us;
+    HeadlessStats stats;
+    headless_get_stats(&stats);
+    
+    if (s->count == s->cap) {
+        s->cap = s->cap ? s->cap * 2 : 64;
+        s->samples = realloc(s->samples, s->cap * sizeof(unsigned long long));
+    }
+    s->samples[s->count++] = us;
+    s->bytes += stats.bytes - s->start_stats.bytes;
+    s->writes += stats.writes - s->start_stats.writes;
+}
+
+// One keystroke as game_play handles it: update the model, then present
+static void bench_key(BenchScenario *s, Game *game, int key) {
+    bench_begin(s);
+    game_handle_input(game, key);
+    board_update(&game->board);
+    bench_end(s);
+}
+
+// Scenarios
+static void bench_cold_setup(BenchScenario *s) {
+    for (int r = 0; r < BENCH_SETUP_RUNS; r++) {
+        Puzzle *puzzle = bench_puzzle_new();
+        GameState *state = calloc(1, sizeof(GameState));
+        screen_clear();
+        screen_invalidate();
+        
+        bench_begin(s);
+        Game *game = game_new_with(state->date, puzzle, state);
+        bench_game_setup(game);
+        bench_end(s);
+        
+        game_free(game);
+    }
+}
+
+// The same with set compact 1
+static void bench_compact_setup(BenchScenario *s) {
+    g_config.compact = true;
+    bench_cold_setup(s);
+    g_config.compact = false;
+}
+
+static void bench_typing(BenchScenario *s) {
+    for (int r = 0; r < BENCH_TYPING_RUNS; r++) {
+        Game *game = bench_game_new();
+        bench_game_setup(game);
+        game_handle_input(game, 'i');
+        
+        // Fill every across answer in order, letting auto-advance
+        // carry the cursor from clue to clue
+        Puzzle *puzzle = game->board.puzzle;
+        for (int i = 0; i < puzzle->clue_count; i++) {
+            Clue *clue = puzzle->clues[i];
+            if (clue->dir != DIR_ACROSS) continue;
+            for (int j = 0; j < clue->length; j++) {
+                bench_key(s, game, clue->answer[j]);
+            }
+        }
+        game_free(game);
+    }
+}
+
+static void bench_tab(BenchScenario *s) {
+    Game *game = bench_game_new();
+    bench_game_setup(game);
+    for (int i = 0; i < BENCH_TAB_PRESSES; i++) {
+        bench_key(s, game, 9);
+    }
+    game_free(game);
+}
+
+// Ctrl+L without the save it also does, which would measure the disk
+static void bench_redraw(BenchScenario *s) {
+    Game *game = bench_game_new();
+    bench_game_setup(game);
+    for (int i = 0; i < BENCH_REDRAW_RUNS; i++) {
+        bench_begin(s);
+        screen_invalidate();
+        game_layout(game);
+        board_update(&game->board);
+        bench_end(s);
+    }
+    game_free(game);
+}
+
+static void bench_next_clue(BenchScenario *s) {
+    Game *game = bench_game_new();
+    bench_game_setup(game);
+    int presses = BENCH_CLUE_LAPS * game->board.puzzle->clue_count;
+    for (int i = 0; i < presses; i++) {
+        bench_key(s, game, 'w');
+    }
+    game_free(game);
+}
+
+// Parsing alone: copying the payload into a new arena, tokenizing it
+// and making the clues
+static void bench_parse(BenchScenario *s) {
+    char *payload = malloc(BENCH_PAYLOAD_SIZE);
+    size_t len = bench_payload_new(payload, BENCH_PAYLOAD_SIZE);
+    
+    for (int r = 0; r < BENCH_PARSE_RUNS; r++) {
+        bench_begin(s);
+        Puzzle *puzzle = parse_puzzle_data(payload, len);
+        bench_end(s);
+        
+        puzzle_free(puzzle);
+    }
+    
+    free(payload);
+}
+
+// Reporting
+static int compare_ull(const void *a, const void *b) {
+    unsigned long long x = *(const unsigned long long *)a;
+    unsigned long long y = *(const unsigned long long *)b;
+    return (x > y) - (x < y);
+}
+
+static unsigned long long percentile(unsigned long long *sorted, int n, int p) {
+    if (n == 0) return 0;
+    return sorted[(long long)(n - 1) * p / 100];
+}
+
+static void bench_write_json(FILE *fp, BenchScenario *s, int count) {
+    int lines, cols;
+    screen_get_size(&lines, &cols);
+    
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"version\": \"%s\",\n", VERSION);
+    fprintf(fp, "  \"terminal\": {\"lines\": %d, \"cols\": %d},\n", lines, cols);
+    fprintf(fp, "  \"puzzle\": {\"rows\": %d, \"cols\": %d},\n",
+            BENCH_SQUARES, BENCH_SQUARES);
+    fprintf(fp, "  \"scenarios\": [\n");
+    
+    for (int i = 0; i < count; i++) {
+        int n = s[i].count;
+        qsort(s[i].samples, n, sizeof(unsigned long long), compare_ull);
+        
+        fprintf(fp, "    {\"name\": \"%s\", \"ops\": %d, "
+                    "\"bytes\": %llu, \"writes\": %lu, "
+                    "\"bytes_per_op\": %.1f, \"writes_per_op\": %.2f, "
+                    "\"p50_us\": %llu, \"p99_us\": %llu, \"max_us\": %llu}%s\n",
+                s[i].name, n, s[i].bytes, s[i].writes,
+                n ? (double)s[i].bytes / n : 0.0,
+                n ? (double)s[i].writes / n : 0.0,
+                percentile(s[i].samples, n, 50),
+                percentile(s[i].samples, n, 99),
+                n ? s[i].samples[n - 1] : 0ULL,
+                i < count - 1 ? "," : "");
+    }
+    
+    fprintf(fp, "  ]\n}\n");
+}
+
+int bench_run(const char *out_path) {
+    FILE *fp = out_path ? fopen(out_path, "w") : stdout;
+    if (!fp) {
+        printf("Cannot open %s\n", out_path);
+        return 1;
+    }
+    
+    // Default settings and an in-memory terminal, so runs are comparable
+    config_default_set();
+    screen_select_backend("headless");
+    screen_setup();
+    
+    BenchScenario scenarios[] = {
+        { .name = "cold_setup", .run = bench_cold_setup },
+        { .name = "compact_setup", .run = bench_compact_setup },
+        { .name = "typing", .run = bench_typing },
+        { .name = "tab", .run = bench_tab },
+        { .name = "redraw", .run = bench_redraw },
+        { .name = "next_clue", .run = bench_next_clue },
+        { .name = "parse", .run = bench_parse }
+    };
+    int count = sizeof(scenarios) / sizeof(scenarios[0]);
+    
+    // Each scenario starts from zeroed frame and latency counters
+    for (int i = 0; i < count; i++) {
+        screen_reset_stats();
+        latency_reset();
+        scenarios[i].run(&scenarios[i]);
+    }
+    
+    bench_write_json(fp, scenarios, count);
+    if (fp != stdout) fclose(fp);
+    
+    for (int i = 0; i < count; i++) {
+        free(scenarios[i].samples);
+    }
+    
+    // Nothing to restore for headless; skipping screen_shutdown also
+    // skips its end-of-run screen dump
+    return 0;
+}
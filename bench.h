@@ -0,0 +1,9 @@
+// bench.h - Rendering benchmarks
+#ifndef BENCH_H
+#define BENCH_H
+
+// Run every scenario against the headless backend and write the results
+// as JSON to out_path, or stdout if it is NULL
+int bench_run(const char *out_path);
+
+#endif // BENCH_H
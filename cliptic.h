@@ -2,13 +2,18 @@
 #ifndef CLIPTIC_H
 #define CLIPTIC_H
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <time.h>
+#include <wchar.h>
 #include <stdbool.h>
 
 #define VERSION "0.1.3"
 #define GRID_MIN_HEIGHT 36
 #define GRID_MIN_WIDTH 61
+#define GRID_MIN_HEIGHT_COMPACT 20
+#define GRID_MIN_WIDTH_COMPACT 45
 
 // Color pairs
 typedef enum {
@@ -83,6 +88,8 @@ typedef struct {
     bool auto_advance;
     bool auto_mark;
     bool auto_save;
+    int max_fps;      // Frame rate cap while input is streaming, 0 for none
+    bool compact;     // One row and two columns per grid square
 } ConfigSettings;
 
 // Menu functions
@@ -101,6 +108,9 @@ void date_to_long_string(Date date, char *buffer, size_t size);
 Date date_today(void);
 Date date_add_days(Date date, int days);
 bool date_valid(Date date);
+unsigned long long clock_now_us(void);
+unsigned long long clock_real_us(void);
+void clock_set_virtual(unsigned long long now_us);
 
 // Unicode characters
 #define UC_HL L'\u2501'     // ─
@@ -118,6 +128,8 @@ bool date_valid(Date date);
 #define UC_BLOCK_L L'\u258C' // ▌
 #define UC_BLOCK_M L'\u2588' // █
 #define UC_BLOCK_R L'\u2590' // ▐
+#define UC_DOT L'\u00B7'     // ·
+#define UC_ELLIPSIS L'\u2026' // …
 
 // Small numbers (subscript)
 extern const wchar_t UC_NUMS[10];
@@ -0,0 +1,230 @@
+// cluelist.c - Side panel listing every clue
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cluelist.h"
+#include "screen.h"
+#include "config.h"
+
+// Width of the clue number column, including the space after it
+#define CLUELIST_NUM_WIDTH 3
+
+static int compare_clues(const void *a, const void *b) {
+    const Clue *x = *(Clue * const *)a;
+    const Clue *y = *(Clue * const *)b;
+    if (x->dir != y->dir) return x->dir == DIR_ACROSS ? -1 : 1;
+    return x->index - y->index;
+}
+
+ClueList* clue_list_new(Puzzle *puzzle) {
+    ClueList *list = calloc(1, sizeof(ClueList));
+    list->count = puzzle->clue_count;
+    list->entries = malloc(list->count * sizeof(Clue*));
+    memcpy(list->entries, puzzle->clues, list->count * sizeof(Clue*));
+    qsort(list->entries, list->count, sizeof(Clue*), compare_clues);
+    
+    for (int i = 0; i < list->count; i++) {
+        if (list->entries[i]->dir == DIR_ACROSS) list->across_count++;
+    }
+    
+    list->layouts = calloc(list->count, sizeof(TextLayout*));
+    list->drawn_done = calloc(list->count, sizeof(bool));
+    list->drawn_active = -1;
+    return list;
+}
+
+// Row layout helpers
+static int list_rows(ClueList *list) {
+    return list->count + 3;
+}
+
+static int list_visible_rows(ClueList *list) {
+    return list->window.y - 2;
+}
+
+static int entry_row(ClueList *list, int i) {
+    return i < list->across_count ? i + 1 : i + 3;
+}
+
+// Entry shown on a list row, or -1 for the headings and the gap
+static int row_entry(ClueList *list, int row) {
+    if (row >= 1 && row <= list->across_count) return row - 1;
+    if (row > list->across_count + 2) return row - 3;
+    return -1;
+}
+
+static bool row_in_view(ClueList *list, int row) {
+    return row >= list->top && row < list->top + list_visible_rows(list);
+}
+
+static int entry_of(ClueList *list, Clue *clue) {
+    if (list->drawn_active >= 0 && list->entries[list->drawn_active] == clue) {
+        return list->drawn_active;
+    }
+    for (int i = 0; i < list->count; i++) {
+        if (list->entries[i] == clue) return i;
+    }
+    return -1;
+}
+
+// Compose one list row into the scratch row and blit it. Entries show
+// the first wrapped line of their hint, with an ellipsis if it goes on.
+static void draw_row(ClueList *list, int row, int active) {
+    int width = list->window.x - 4;
+    int color = CP_DEFAULT;
+    ScreenCell *cells = list->row;
+    
+    for (int x = 0; x < width; x++) {
+        cells[x].ch = L' ';
+        cells[x].underline = false;
+    }
+    
+    int i = row_entry(list, row);
+    if (i >= 0) {
+        Clue *clue = list->entries[i];
+        if (i == active) {
+            color = g_colors.meta;
+        } else if (clue->done) {
+            color = g_colors.num;
+        }
+        
+        char num[8];
+        snprintf(num, sizeof(num), "%2d", clue->index);
+        for (int x = 0; num[x] && x < CLUELIST_NUM_WIDTH - 1 && x < width; x++) {
+            cells[x].ch = (wchar_t)num[x];
+        }
+        
+        int hint_width = width - CLUELIST_NUM_WIDTH;
+        if (hint_width > 0) {
+            if (!list->layouts[i]) list->layouts[i] = layout_new();
+            TextLayout *layout = list->layouts[i];
+            if (!layout_valid(layout, hint_width, CP_DEFAULT)) {
+                layout_wrap(layout, clue->hint, hint_width, CP_DEFAULT);
+            }
+            
+            ScreenCell *hint = &cells[CLUELIST_NUM_WIDTH];
+            if (layout->rows > 0) {
+                memcpy(hint, layout->cells, hint_width * sizeof(ScreenCell));
+            }
+            if (layout->rows > 1) {
+                int end = hint_width - 1;
+                while (end > 0 && hint[end].ch == L' ') end--;
+                if (end < hint_width - 1) end++;
+                if (hint[end].ch == SCREEN_WIDE_TAIL) hint[end--].ch = L' ';
+                hint[end].ch = UC_ELLIPSIS;
+            }
+        }
+        list->drawn_done[i] = clue->done;
+    } else if (row == 0 || row == list->across_count + 2) {
+        const wchar_t *title = row == 0 ? L"Across" : L"Down";
+        color = g_colors.title;
+        for (int x = 0; title[x] && x < width; x++) {
+            cells[x].ch = title[x];
+        }
+    }
+    
+    for (int x = 0; x < width; x++) {
+        cells[x].color = color;
+    }
+    screen_blit(list->window.line + 1 + row - list->top, list->window.col + 2,
+                cells, width);
+}
+
+static void draw_rows(ClueList *list, int active) {
+    int visible = list_visible_rows(list);
+    for (int r = list->top; r < list->top + visible && r < list_rows(list); r++) {
+        draw_row(list, r, active);
+    }
+    list->drawn_active = active;
+}
+
+// Scroll so the active entry is in view with a row either side of it,
+// which also brings its heading in. Returns true if the list moved.
+static bool scroll_to(ClueList *list, int active) {
+    if (active < 0) return false;
+    
+    int visible = list_visible_rows(list);
+    int margin = visible > 2 ? 1 : 0;
+    int row = entry_row(list, active);
+    int top = list->top;
+    
+    if (row - margin < top) top = row - margin;
+    if (row + margin >= top + visible) top = row + margin - visible + 1;
+    if (top > list_rows(list) - visible) top = list_rows(list) - visible;
+    if (top < 0) top = 0;
+    
+    if (top == list->top) return false;
+    list->top = top;
+    return true;
+}
+
+// Show the panel in the given window; it is drawn by the next
+// clue_list_draw
+void clue_list_place(ClueList *list, int y, int x, int line, int col) {
+    window_init(&list->window, y, x, line, col);
+    list->shown = true;
+    list->drawn_active = -1;
+    
+    free(list->row);
+    list->row = malloc((x > 4 ? x - 4 : 1) * sizeof(ScreenCell));
+    
+    int visible = list_visible_rows(list);
+    if (list->top > list_rows(list) - visible) list->top = list_rows(list) - visible;
+    if (list->top < 0) list->top = 0;
+}
+
+void clue_list_hide(ClueList *list) {
+    list->shown = false;
+}
+
+// Draw the frame and every row in view
+void clue_list_draw(ClueList *list, Clue *active) {
+    if (!list->shown || list_visible_rows(list) <= 0) return;
+    
+    int i = entry_of(list, active);
+    scroll_to(list, i);
+    window_draw(&list->window, g_colors.box);
+    draw_rows(list, i);
+}
+
+// Bring the panel in line with the active clue and solved states. Only
+// entries whose highlight or solved state changed are repainted, unless
+// the list had to scroll.
+void clue_list_update(ClueList *list, Clue *active) {
+    if (!list->shown || list_visible_rows(list) <= 0) return;
+    
+    int i = entry_of(list, active);
+    if (scroll_to(list, i)) {
+        draw_rows(list, i);
+        return;
+    }
+    
+    int old = list->drawn_active;
+    if (i != old) {
+        if (old >= 0 && row_in_view(list, entry_row(list, old))) {
+            draw_row(list, entry_row(list, old), i);
+        }
+        if (i >= 0) draw_row(list, entry_row(list, i), i);
+        list->drawn_active = i;
+    }
+    
+    int visible = list_visible_rows(list);
+    for (int r = list->top; r < list->top + visible && r < list_rows(list); r++) {
+        int e = row_entry(list, r);
+        if (e >= 0 && list->entries[e]->done != list->drawn_done[e]) {
+            draw_row(list, r, i);
+        }
+    }
+}
+
+void clue_list_free(ClueList *list) {
+    if (!list) return;
+    for (int i = 0; i < list->count; i++) {
+        layout_free(list->layouts[i]);
+    }
+    free(list->layouts);
+    free(list->entries);
+    free(list->drawn_done);
+    free(list->row);
+    free(list);
+}
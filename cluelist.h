@@ -0,0 +1,36 @@
+// cluelist.h - Side panel listing every clue
+#ifndef CLUELIST_H
+#define CLUELIST_H
+
+#include <stdbool.h>
+#include "windows.h"
+#include "puzzle.h"
+
+// Panel widths; narrower terminals get the cluebox alone
+#define CLUELIST_MIN_WIDTH 28
+#define CLUELIST_MAX_WIDTH 48
+
+// Clue list structure. Rows are the "Across" heading, the across
+// entries, a blank row, the "Down" heading and the down entries; only
+// the rows between top and the bottom of the window are drawn.
+typedef struct {
+    Window window;
+    bool shown;
+    Clue **entries;        // Across then down, by clue number
+    int count;
+    int across_count;
+    TextLayout **layouts;  // Wrapped hint per entry, built when first shown
+    int top;               // First list row in view
+    int drawn_active;      // Entry drawn highlighted, -1 if none
+    bool *drawn_done;      // Solved state each entry was drawn with
+    ScreenCell *row;       // Scratch row for composing an entry
+} ClueList;
+
+ClueList* clue_list_new(Puzzle *puzzle);
+void clue_list_place(ClueList *list, int y, int x, int line, int col);
+void clue_list_hide(ClueList *list);
+void clue_list_draw(ClueList *list, Clue *active);
+void clue_list_update(ClueList *list, Clue *active);
+void clue_list_free(ClueList *list);
+
+#endif // CLUELIST_H
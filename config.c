@@ -36,6 +36,8 @@ void config_default_set(void) {
     g_config.auto_advance = true;
     g_config.auto_mark = true;
     g_config.auto_save = true;
+    g_config.max_fps = 60;
+    g_config.compact = false;
 }
 
 void config_custom_set(void) {
@@ -97,6 +99,8 @@ void config_generate_file(void) {
     fprintf(fp, "set auto_advance %d\n", g_config.auto_advance ? 1 : 0);
     fprintf(fp, "set auto_mark %d\n", g_config.auto_mark ? 1 : 0);
     fprintf(fp, "set auto_save %d\n", g_config.auto_save ? 1 : 0);
+    fprintf(fp, "set max_fps %d\n", g_config.max_fps);
+    fprintf(fp, "set compact %d\n", g_config.compact ? 1 : 0);
     
     fclose(fp);
 }
@@ -157,4 +161,6 @@ void config_parse_setting(const char *key, int value) {
     if (strcmp(key, "auto_advance") == 0) g_config.auto_advance = (value == 1);
     else if (strcmp(key, "auto_mark") == 0) g_config.auto_mark = (value == 1);
     else if (strcmp(key, "auto_save") == 0) g_config.auto_save = (value == 1);
+    else if (strcmp(key, "max_fps") == 0) g_config.max_fps = value;
+    else if (strcmp(key, "compact") == 0) g_config.compact = (value == 1);
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <direct.h>
 #include <time.h>
 #include "database.h"
+#include "game.h"
 
 // If sqlite3.h is not available, we'll need to either:
 // 1. Download it from https://www.sqlite.org/download.html
@@ -173,7 +174,7 @@ bool state_save(GameState *state, Game *game) {
         return false;
     }
     
-    sqlite3_bind_int(stmt, 1, game->timer.time);
+    sqlite3_bind_int(stmt, 1, timer_seconds(&game->timer));
     sqlite3_bind_text(stmt, 2, chars_json, -1, SQLITE_TRANSIENT);
     sqlite3_bind_int(stmt, 3, puzzle_count_done(game->board.puzzle));
     sqlite3_bind_int(stmt, 4, game->board.puzzle->clue_count);
@@ -327,9 +328,10 @@ bool scores_add(Game *game) {
     snprintf(today_str, sizeof(today_str), "%04d-%02d-%02d", today.year, today.month, today.day);
     
     // Format time
-    int hours = game->timer.time / 3600;
-    int minutes = (game->timer.time % 3600) / 60;
-    int seconds = game->timer.time % 60;
+    int time = timer_seconds(&game->timer);
+    int hours = time / 3600;
+    int minutes = (time % 3600) / 60;
+    int seconds = time % 60;
     snprintf(time_str, sizeof(time_str), "%02d:%02d:%02d", hours, minutes, seconds);
     
     sqlite3_stmt *stmt;
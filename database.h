@@ -6,6 +6,9 @@
 #include "cliptic.h"
 #include "puzzle.h"
 
+// Forward declaration
+typedef struct Game Game;
+
 // Database paths
 #define DB_DIR_PATH "%USERPROFILE%\\.config\\cliptic\\db"
 #define DB_FILE_PATH "%USERPROFILE%\\.config\\cliptic\\db\\cliptic.db"
@@ -0,0 +1,165 @@
+// events.c - Deadlines and cross-thread work for the main loop
+//
+// The main thread sleeps in exactly one place: the backend's key wait.
+// That wait is bounded by the nearest armed deadline and is cut short by
+// input, a resize or screen_wake, so nothing runs on a fixed period.
+#include <stdlib.h>
+#include "events.h"
+#include "cliptic.h"
+#include "screen.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// Armed deadlines, soonest first
+static Deadline *deadlines;
+
+// Posted work, guarded by a lock since any thread may post
+typedef struct {
+    void (*fn)(void *arg);
+    void *arg;
+} Posted;
+
+static Posted posted[EVENTS_QUEUE_SIZE];
+static int posted_head;
+static int posted_count;
+
+#ifdef _WIN32
+static SRWLOCK lock = SRWLOCK_INIT;
+
+static void posted_lock(void) {
+    AcquireSRWLockExclusive(&lock);
+}
+
+static void posted_unlock(void) {
+    ReleaseSRWLockExclusive(&lock);
+}
+#else
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void posted_lock(void) {
+    pthread_mutex_lock(&lock);
+}
+
+static void posted_unlock(void) {
+    pthread_mutex_unlock(&lock);
+}
+#endif
+
+// Deadline functions
+void deadline_init(Deadline *d, void (*fire)(void *arg), void *arg) {
+    d->when = 0;
+    d->fire = fire;
+    d->arg = arg;
+    d->next = NULL;
+}
+
+// Schedule d for when, replacing any earlier schedule
+void deadline_arm(Deadline *d, unsigned long long when) {
+    deadline_cancel(d);
+    if (when == 0) when = 1;
+    d->when = when;
+    
+    Deadline **p = &deadlines;
+    while (*p && (*p)->when <= when) p = &(*p)->next;
+    d->next = *p;
+    *p = d;
+}
+
+void deadline_cancel(Deadline *d) {
+    if (!d->when) return;
+    for (Deadline **p = &deadlines; *p; p = &(*p)->next) {
+        if (*p == d) {
+            *p = d->next;
+            break;
+        }
+    }
+    d->when = 0;
+    d->next = NULL;
+}
+
+bool deadline_armed(Deadline *d) {
+    return d->when != 0;
+}
+
+// Posted work
+bool events_post(void (*fn)(void *arg), void *arg) {
+    bool queued = false;
+    
+    posted_lock();
+    if (posted_count < EVENTS_QUEUE_SIZE) {
+        int slot = (posted_head + posted_count) % EVENTS_QUEUE_SIZE;
+        posted[slot].fn = fn;
+        posted[slot].arg = arg;
+        posted_count++;
+        queued = true;
+    }
+    posted_unlock();
+    
+    if (queued) screen_wake();
+    return queued;
+}
+
+// Drop queued work for arg, for owners about to free it
+void events_cancel_posted(void *arg) {
+    posted_lock();
+    for (int i = 0; i < posted_count; i++) {
+        Posted *p = &posted[(posted_head + i) % EVENTS_QUEUE_SIZE];
+        if (p->arg == arg) p->fn = NULL;
+    }
+    posted_unlock();
+}
+
+// Run posted work and every deadline that is due. Returns true if
+// anything ran, so the caller knows the frame may have changed.
+bool events_dispatch(void) {
+    bool ran = false;
+    
+    while (1) {
+        Posted p;
+        bool got = false;
+        posted_lock();
+        if (posted_count > 0) {
+            p = posted[posted_head];
+            posted_head = (posted_head + 1) % EVENTS_QUEUE_SIZE;
+            posted_count--;
+            got = true;
+        }
+        posted_unlock();
+        
+        if (!got) break;
+        if (!p.fn) continue; // Cancelled
+        p.fn(p.arg);
+        ran = true;
+    }
+    
+    unsigned long long now = clock_now_us();
+    while (deadlines && deadlines->when <= now) {
+        Deadline *d = deadlines;
+        deadlines = d->next;
+        d->when = 0;
+        d->next = NULL;
+        d->fire(d->arg);
+        ran = true;
+    }
+    
+    return ran;
+}
+
+// How long the loop may sleep: timeout_ms (< 0 for no limit) cut down to
+// the nearest deadline
+int events_timeout(int timeout_ms) {
+    if (!deadlines) return timeout_ms;
+    
+    unsigned long long now = clock_now_us();
+    int wait = 0;
+    if (deadlines->when > now) {
+        unsigned long long ms = (deadlines->when - now + 999) / 1000;
+        wait = ms > 0x7FFFFFFF ? 0x7FFFFFFF : (int)ms;
+    }
+    
+    return (timeout_ms < 0 || wait < timeout_ms) ? wait : timeout_ms;
+}
@@ -0,0 +1,34 @@
+// events.h - Deadlines and cross-thread work for the main loop
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdbool.h>
+
+#define EVENTS_QUEUE_SIZE 64
+
+// A callback the main loop runs once its time has come. Deadlines live
+// in the structures that own them and are linked into the loop while
+// armed; an owner must cancel its deadline before freeing it.
+typedef struct Deadline {
+    unsigned long long when;  // Due time (us, clock_now_us), 0 if idle
+    void (*fire)(void *arg);
+    void *arg;
+    struct Deadline *next;
+} Deadline;
+
+// Deadline functions (main thread only)
+void deadline_init(Deadline *d, void (*fire)(void *arg), void *arg);
+void deadline_arm(Deadline *d, unsigned long long when);
+void deadline_cancel(Deadline *d);
+bool deadline_armed(Deadline *d);
+
+// Work handed to the main thread. events_post may be called from any
+// thread and wakes the loop; the callback runs on the main thread.
+bool events_post(void (*fn)(void *arg), void *arg);
+void events_cancel_posted(void *arg);
+
+// Loop functions, used by the screen layer's key waits
+bool events_dispatch(void);
+int events_timeout(int timeout_ms);
+
+#endif // EVENTS_H
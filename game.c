@@ -3,60 +3,80 @@
 #include <stdlib.h>
 #include <string.h>
 #include <windows.h>
-#include <process.h>
 #include "game.h"
 #include "screen.h"
 #include "config.h"
 #include "menus.h"
+#include "events.h"
+#include "input.h"
+#include "latency.h"
+#include "json.h"
+
+// Lines kept for the cluebox when sizing the grid view
+#define CLUEBOX_MIN_LINES 3
+
+// How long transient messages stay on the bottom bar
+#define STATUS_MESSAGE_MS 1000
+
+// Macro registers, a to z
+#define MACRO_REGISTERS 26
+
+static void board_place(Board *board);
+static void timer_refresh(void *arg);
+static LatencyClass game_key_class(Game *game, int key);
+static void game_macros_reset(void);
 
 // Game implementation
 Game* game_new(Date date) {
-    Game *game = calloc(1, sizeof(Game));
-    game->date = date;
-    
-    // Initialize state
-    game->state = state_new(date);
-    
-    // Initialize board
-    game->board.puzzle = puzzle_new(date);
-    if (!game->board.puzzle) {
-        state_free(game->state);
-        free(game);
+    GameState *state = state_new(date);
+    Puzzle *puzzle = puzzle_new(date);
+    if (!puzzle) {
+        state_free(state);
         return NULL;
     }
+    return game_new_with(date, puzzle, state);
+}
+
+// Build a game around an already loaded puzzle and state; the game
+// takes ownership of both
+Game* game_new_with(Date date, Puzzle *puzzle, GameState *state) {
+    Game *game = calloc(1, sizeof(Game));
+    game->date = date;
+    game->state = state;
+    game->board.puzzle = puzzle;
     
     game->board.grid = grid_new(game->board.puzzle->size.y, 
                                game->board.puzzle->size.x, 1, -1);
     
-    // Create cluebox
+    // Create cluebox and clue list
     game->board.cluebox = calloc(1, sizeof(Window));
-    int lines, cols;
-    screen_get_size(&lines, &cols);
-    window_init(game->board.cluebox, lines - game->board.grid->window.y - 2, 
-                0, game->board.grid->window.y + 1, 0);
+    game->board.clue_list = clue_list_new(game->board.puzzle);
+    board_place(&game->board);
     
     // Create cursor
     game->board.cursor = calloc(1, sizeof(Cursor));
     game->board.cursor->grid = game->board.grid;
     
     // Initialize timer
-    game->timer.time = game->state->time;
+    game->timer.banked_us = (unsigned long long)game->state->time * 1000000ULL;
     game->timer.running = false;
-    game->timer.callback = NULL;
+    deadline_init(&game->timer.refresh, timer_refresh, &game->timer);
     
     // Create UI elements
     game->top_bar = top_bar_new(date);
     game->bottom_bar = bottom_bar_new();
+    game->timer.bar = game->top_bar;
     
     // Set initial values
     game->mode = MODE_NORMAL;
     game->continue_game = true;
     game->unsaved = false;
+    game->persist = true;
     
-    // Link cells to clues
+    // Link cells to clues, in the puzzle's arena
     for (int i = 0; i < game->board.puzzle->clue_count; i++) {
         Clue *clue = game->board.puzzle->clues[i];
-        clue->cells = calloc(clue->length, sizeof(Cell*));
+        clue->cells = arena_alloc(game->board.puzzle->arena, clue->length * sizeof(Cell*));
         for (int j = 0; j < clue->length; j++) {
             clue->cells[j] = grid_get_cell(game->board.grid, 
                                           clue->coords[j].y, 
@@ -70,50 +90,92 @@ Game* game_new(Date date) {
 void game_free(Game *game) {
     if (!game) return;
     
+    timer_stop(&game->timer);
     state_free(game->state);
     puzzle_free(game->board.puzzle);
     grid_free(game->board.grid);
     free(game->board.cluebox);
+    clue_list_free(game->board.clue_list);
     free(game->board.cursor);
     top_bar_free(game->top_bar);
     bottom_bar_free(game->bottom_bar);
     free(game);
 }
 
-// Timer thread function
-static unsigned __stdcall timer_thread(void *arg) {
+static unsigned long long timer_elapsed_us(Timer *timer) {
+    unsigned long long us = timer->banked_us;
+    if (timer->running) us += clock_now_us() - timer->started_us;
+    return us;
+}
+
+unsigned long long timer_elapsed_ms(Timer *timer) {
+    return timer_elapsed_us(timer) / 1000;
+}
+
+int timer_seconds(Timer *timer) {
+    return (int)(timer_elapsed_us(timer) / 1000000ULL);
+}
+
+// Show the time and come back when it next reaches a whole second
+static void timer_refresh(void *arg) {
     Timer *timer = (Timer*)arg;
+    unsigned long long us = timer_elapsed_us(timer);
     
-    while (timer->running) {
-        Sleep(1000);
-        if (timer->running) {
-            timer->time++;
-            if (timer->callback) timer->callback();
-        }
+    if (timer->bar) top_bar_time(timer->bar, (int)(us / 1000000ULL));
+    if (timer->running) {
+        deadline_arm(&timer->refresh, clock_now_us() + 1000000ULL - us % 1000000ULL);
     }
-    
-    return 0;
 }
 
 void timer_start(Timer *timer) {
+    if (timer->running) return;
     timer->running = true;
-    _beginthreadex(NULL, 0, timer_thread, timer, 0, NULL);
+    timer->started_us = clock_now_us();
+    timer_refresh(timer);
 }
 
 void timer_stop(Timer *timer) {
+    if (!timer->running) return;
+    timer->banked_us += clock_now_us() - timer->started_us;
     timer->running = false;
+    deadline_cancel(&timer->refresh);
 }
 
 void timer_reset(Timer *timer) {
-    timer->running = false;
-    timer->time = 0;
+    timer_stop(timer);
+    timer->banked_us = 0;
+    if (timer->bar) top_bar_time(timer->bar, 0);
 }
 
 // Board functions
-void board_setup(Board *board, GameState *state) {
-    // Draw grid
-    grid_draw(board->grid);
+
+// Write the letters of a saved board, laid out as game_generate_state_json
+// writes them, back into the grid
+static void board_restore(Board *board, const char *chars_json) {
+    char *text = strdup(chars_json);
+    JsonDoc doc = {0};
+    
+    if (json_parse(text, strlen(text), &doc) && doc.tokens[0].type == JSON_ARRAY) {
+        for (int tok = 1; tok < doc.tokens[0].end; tok = doc.tokens[tok].end) {
+            int sq = json_get(&doc, tok, "sq");
+            char *ch = json_string(&doc, json_get(&doc, tok, "char"));
+            int y, x;
+            if (!ch || !json_int(&doc, json_get(&doc, sq, "y"), &y) ||
+                !json_int(&doc, json_get(&doc, sq, "x"), &x)) continue;
+            
+            Cell *cell = grid_get_cell(board->grid, y, x);
+            if (cell && !cell->blocked &&
+                ((ch[0] >= 'A' && ch[0] <= 'Z') || (ch[0] >= 'a' && ch[0] <= 'z'))) {
+                cell_write(cell, toupper(ch[0]));
+            }
+        }
+    }
     
+    json_free(&doc);
+    free(text);
+}
+
+void board_setup(Board *board, GameState *state) {
     // Add indices
     for (int i = 0; i < board->puzzle->clue_count; i++) {
         Clue *clue = board->puzzle->clues[i];
@@ -131,10 +193,14 @@ void board_setup(Board *board, GameState *state) {
         cell_set_block(cell);
     }
     
+    // Prerender borders, blocks and numbers, then draw the grid
+    grid_bake(board->grid);
+    grid_draw(board->grid);
+    
     // Load saved state if exists
     if (state && state->exists && state->chars_json) {
-        // Parse JSON and restore cell states
-        // This would need a JSON parser implementation
+        board_restore(board, state->chars_json);
+        if (g_config.auto_mark) puzzle_check_all(board->puzzle);
     }
     
     // Set initial clue
@@ -144,35 +210,68 @@ void board_setup(Board *board, GameState *state) {
         cursor_set(board->cursor, board->current_clue->start.y, 
                                  board->current_clue->start.x);
     }
+    clue_activate(board->current_clue);
+    board_draw_cluebox(board);
+    clue_list_draw(board->clue_list, board->current_clue);
     
     board_update(board);
 }
 
-void board_update(Board *board) {
-    cursor_reset(board->cursor);
-    // Refresh would be called here if needed
+// Size the grid view, clue list and cluebox for the current screen. With
+// room beside the grid the clue list takes the right-hand side and the
+// grid is centered in what is left.
+static void board_place(Board *board) {
+    int lines, cols;
+    screen_get_size(&lines, &cols);
+    
+    // Show as much of the grid as fits; larger puzzles scroll
+    Grid *grid = board->grid;
+    grid_fit(grid, lines - 2 - CLUEBOX_MIN_LINES, cols);
+    
+    int area = cols;
+    int panel = cols - grid->window.x - 2;
+    if (panel > CLUELIST_MAX_WIDTH) panel = CLUELIST_MAX_WIDTH;
+    if (panel >= CLUELIST_MIN_WIDTH) {
+        area = cols - panel;
+        grid->window.col = (area - grid->window.x) / 2;
+        clue_list_place(board->clue_list, lines - 2, panel, 1, area);
+    } else {
+        clue_list_hide(board->clue_list);
+    }
+    
+    window_init(board->cluebox, lines - grid->window.y - 2,
+                area, grid->window.y + 1, 0);
 }
 
-void board_redraw(Board *board) {
-    grid_draw(board->grid);
-    
-    // Redraw all cells
-    for (int y = 0; y < board->grid->sq.y; y++) {
-        for (int x = 0; x < board->grid->sq.x; x++) {
-            Cell *cell = grid_get_cell(board->grid, y, x);
-            if (cell->buffer != ' ' && !cell->blocked) {
-                cell->locked = false;
-                cell_write(cell, cell->buffer);
-            }
-        }
+void board_update(Board *board) {
+    // Keep the cursor in view; a scroll repaints the visible squares
+    if (grid_follow(board->grid, board->cursor->pos.y, board->cursor->pos.x)) {
+        grid_draw(board->grid);
     }
     
-    if (g_config.auto_mark) {
-        puzzle_check_all(board->puzzle);
+    // Catch the cluebox and clue list up with clue moves and solves
+    Clue *clue = board->current_clue;
+    if (board->cluebox_clue != clue || board->cluebox_done != clue->done) {
+        board_draw_cluebox(board);
     }
+    clue_list_update(board->clue_list, clue);
     
-    if (board->current_clue) {
-        clue_activate(board->current_clue);
+    grid_flush(board->grid);
+    cursor_reset(board->cursor);
+    screen_present();
+}
+
+void board_redraw(Board *board) {
+    // Cells keep their letters and marks, so the static layer plus
+    // the cells drawn over it is the whole grid
+    grid_draw(board->grid);
+}
+
+// Re-evaluate marks for the clues crossing an edited cell
+static void board_check_cell(Board *board, Cell *cell) {
+    for (int d = 0; d < 2; d++) {
+        Clue *clue = board->puzzle->map_index[d][cell->sq.y][cell->sq.x];
+        if (clue) clue_check(clue);
     }
 }
 
@@ -193,21 +292,40 @@ void board_move(Board *board, int y, int x) {
             board->current_clue = new_clue;
             board->dir = new_clue->dir;
             clue_activate(board->current_clue);
-            
-            // Update cluebox
-            window_draw(board->cluebox, g_colors.cluebox);
-            console_set_color(board->current_clue->done ? g_colors.correct : g_colors.meta);
-            window_add_str(board->cluebox, 0, 2, clue_get_meta(board->current_clue));
-            window_wrap_str(board->cluebox, 1, board->current_clue->hint);
         }
     }
 }
 
+void board_draw_cluebox(Board *board) {
+    Clue *clue = board->current_clue;
+    int color = clue->done ? g_colors.correct : g_colors.meta;
+    
+    window_draw(board->cluebox, g_colors.cluebox);
+    console_set_color(color);
+    window_add_str(board->cluebox, 0, 2, clue_get_meta(clue));
+    
+    // The wrapped hint is kept per clue and rebuilt only when the
+    // cluebox width changes, so moving between clues is a plain copy
+    int width = board->cluebox->x - 4;
+    if (!clue->hint_layout) clue->hint_layout = layout_new();
+    if (!layout_valid(clue->hint_layout, width, color)) {
+        layout_wrap(clue->hint_layout, clue->hint, width, color);
+    }
+    window_draw_layout(board->cluebox, 1, clue->hint_layout);
+    
+    board->cluebox_clue = clue;
+    board->cluebox_done = clue->done;
+}
+
 void board_insert_char(Board *board, char ch, bool advance) {
     Cell *cell = grid_get_cell(board->grid, board->cursor->pos.y, board->cursor->pos.x);
     if (cell) {
         cell_write(cell, toupper(ch));
         
+        if (g_config.auto_mark) {
+            board_check_cell(board, cell);
+        }
+        
         if (advance) {
             // Check if we're at the end of the clue
             bool at_end = true;
@@ -226,10 +344,21 @@ void board_insert_char(Board *board, char ch, bool advance) {
                           board->dir == DIR_ACROSS ? 1 : 0);
             }
         }
+    }
+}
+
+// Fill the current answer from the cursor with the letters of a paste,
+// skipping anything else and stopping at the end of the answer
+void board_insert_text(Board *board, const char *text, size_t len) {
+    Clue *clue = board->current_clue;
+    for (size_t i = 0; i < len; i++) {
+        char ch = text[i];
+        if (!((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z'))) continue;
         
-        if (g_config.auto_mark) {
-            clue_check(board->current_clue);
-        }
+        Cell *cell = grid_get_cell(board->grid, board->cursor->pos.y, board->cursor->pos.x);
+        bool last = !cell || cell == clue->cells[clue->length - 1];
+        board_insert_char(board, ch, true);
+        if (last || board->current_clue != clue) break;
     }
 }
 
@@ -237,7 +366,10 @@ void board_delete_char(Board *board, bool advance) {
     Cell *cell = grid_get_cell(board->grid, board->cursor->pos.y, board->cursor->pos.x);
     if (cell) {
         cell_write(cell, ' ');
-        cell_underline(cell);
+        
+        if (g_config.auto_mark) {
+            board_check_cell(board, cell);
+        }
         
         if (advance) {
             // Check if we're at the start
@@ -333,7 +465,9 @@ void board_goto_cell(Board *board, int n) {
 
 void board_clear_clue(Board *board) {
     clue_clear(board->current_clue);
-    clue_activate(board->current_clue);
+    if (g_config.auto_mark) {
+        clue_check(board->current_clue);
+    }
 }
 
 void board_reveal_clue(Board *board) {
@@ -389,7 +523,10 @@ void game_play(Game *game) {
     }
     
     // Add to recent puzzles
-    recents_add(game->date);
+    if (game->persist) recents_add(game->date);
+    
+    game_macros_reset();
+    latency_reset();
     
     // Draw UI
     top_bar_draw(game->top_bar);
@@ -403,19 +540,47 @@ void game_play(Game *game) {
     timer_start(&game->timer);
     
     // Main game loop
+    unsigned long long frame_us = g_config.max_fps > 0 ? 1000000ULL / g_config.max_fps : 0;
+    unsigned long long last_frame = 0;
     while (game->continue_game && !puzzle_is_complete(game->board.puzzle)) {
+        // Timer ticks and status messages are handled by the event
+        // loop while this waits
         int key = console_get_key();
+        latency_key(game_key_class(game, key));
         game_handle_input(game, key);
+        
+        // Apply everything already queued before drawing, and hold the
+        // frame until the frame interval has passed. Keys after the one
+        // that completes the puzzle are left unread.
+        while (game->continue_game && !puzzle_is_complete(game->board.puzzle)) {
+            unsigned long long now = clock_now_us();
+            int wait_ms = 0;
+            if (now < last_frame + frame_us) {
+                wait_ms = (int)((last_frame + frame_us - now + 999) / 1000);
+            }
+            
+            key = console_poll_key(wait_ms);
+            if (key == -2) break; // Nothing pending
+            latency_key(game_key_class(game, key));
+            game_handle_input(game, key);
+        }
+        
         board_update(&game->board);
+        latency_frame_done();
+        last_frame = clock_now_us();
     }
     
     // Stop timer
     timer_stop(&game->timer);
     
+    // CLIPTIC_LATENCY_LOG names a file for the keystroke latencies
+    const char *latency_path = getenv("CLIPTIC_LATENCY_LOG");
+    if (latency_path) latency_write(latency_path);
+    
     // Save if needed
     if (puzzle_is_complete(game->board.puzzle)) {
         game_save(game);
-        scores_add(game);
+        if (game->persist) scores_add(game);
         menu_puzzle_complete_show();
     } else if (g_config.auto_save) {
         game_save(game);
@@ -433,22 +598,15 @@ void game_unpause(Game *game) {
 }
 
 void game_save(Game *game) {
-    state_save(game->state, game);
-    
-    // Show "Saved!" message
-    console_set_color(g_colors.bar);
-    console_move_cursor(game->bottom_bar->window.line, 10);
-    console_write_string(L"Saved!");
-    Sleep(1000);
-    console_move_cursor(game->bottom_bar->window.line, 10);
-    console_write_string(L"      ");
+    if (game->persist) state_save(game->state, game);
     
     game->unsaved = false;
     bottom_bar_unsaved(game->bottom_bar, false);
+    bottom_bar_status(game->bottom_bar, L"Saved!", STATUS_MESSAGE_MS);
 }
 
 void game_reset(Game *game) {
-    if (game->state->exists) {
+    if (game->persist && game->state->exists) {
         state_delete(game->date);
     }
     board_clear_all(&game->board);
@@ -465,15 +623,41 @@ void game_exit(Game *game) {
     screen_clear();
 }
 
-void game_redraw(Game *game) {
-    game_save(game);
+// Compose the whole game screen from the bars, the grid layer and cell
+// state, without touching the model
+static void game_draw(Game *game) {
     screen_clear();
-    
-    // Redraw everything
     top_bar_draw(game->top_bar);
     bottom_bar_draw(game->bottom_bar);
     bottom_bar_mode(game->bottom_bar, game->mode);
+    bottom_bar_unsaved(game->bottom_bar, game->unsaved);
     board_redraw(&game->board);
+    board_draw_cluebox(&game->board);
+    clue_list_draw(game->board.clue_list, game->board.current_clue);
+}
+
+void game_redraw(Game *game) {
+    game_save(game);
+    screen_invalidate();
+    game_draw(game);
+}
+
+// Re-place every window for the current (cached) screen size after a
+// resize, then repaint
+void game_layout(Game *game) {
+    if (screen_too_small()) {
+        interface_resizer_show();
+    }
+    
+    int lines, cols;
+    screen_get_size(&lines, &cols);
+    
+    board_place(&game->board);
+    grid_follow(game->board.grid, game->board.cursor->pos.y, game->board.cursor->pos.x);
+    window_init(&game->top_bar->window, 1, 0, 0, 0);
+    window_init(&game->bottom_bar->window, 1, 0, lines - 1, 0);
+    
+    game_draw(game);
 }
 
 // Generate JSON state (simplified)
@@ -510,15 +694,154 @@ char* game_generate_state_json(Game *game) {
 static int await_number = 0;
 static void (*await_callback)(Game*, int) = NULL;
 
+// Macros and repeat. Keys are kept as they were typed and fed back
+// through the key handler in one go; the game loop draws once after the
+// key that started them, so a replay of any length is a single frame.
+typedef struct {
+    int *keys;
+    int count;
+    int cap;
+} KeyList;
+
+static KeyList registers[MACRO_REGISTERS];
+static bool playing[MACRO_REGISTERS];  // Guards against a macro calling itself
+static int recording = -1;             // Register being recorded, -1 if none
+static int last_played = -1;           // Register for @@
+static int macro_count = 1;            // Count given before @
+static int replay_depth = 0;           // > 0 while keys are fed back
+
+static KeyList change;                 // Keys of the command in progress
+static KeyList last_change;            // Last completed change, for .
+static bool change_edits;              // The command in progress edits
+
 // Forward declarations for static functions
+static void game_dispatch_key(Game *game, int key);
 static void game_handle_number_command(Game *game, int key);
 static void game_handle_replace(Game *game, int key);
 static void game_handle_delete(Game *game, int key);
 static void game_handle_change(Game *game, int key);
+static void game_handle_record(Game *game, int key);
+static void game_handle_play(Game *game, int key);
 
-void game_handle_input(Game *game, int key) {
-    // Handle control keys
+// Registers carry over between puzzles; a recording does not
+static void game_macros_reset(void) {
+    recording = -1;
+    change.count = 0;
+    change_edits = false;
+}
+
+static void key_list_add(KeyList *list, int key) {
+    if (list->count == list->cap) {
+        list->cap = list->cap ? list->cap * 2 : 32;
+        list->keys = realloc(list->keys, list->cap * sizeof(int));
+    }
+    list->keys[list->count++] = key;
+}
+
+// Keys a macro keeps: not resizes, pastes or keys that open menus, leave
+// the game or only affect the display
+static bool macro_key(int key) {
+    if (key < 0 || key >= KEY_PASTE) return false;
     if (key >= 1 && key <= 26) {
+        return key == 7 || key == 9 || key == 18 || key == 19; // ^G Tab ^R ^S
+    }
+    return true;
+}
+
+// Feed keys back through the handler. Neither recording nor change
+// tracking sees them; the command that asked for them is what they
+// were recorded under. Like live input, they stop once the puzzle is
+// complete.
+static void game_replay_keys(Game *game, const int *keys, int count) {
+    bool edits = change_edits;
+    replay_depth++;
+    for (int i = 0; i < count && game->continue_game &&
+                    !puzzle_is_complete(game->board.puzzle); i++) {
+        game_dispatch_key(game, keys[i]);
+    }
+    replay_depth--;
+    change_edits = edits;
+}
+
+static void game_play_register(Game *game, int reg, int n) {
+    if (reg < 0 || playing[reg] || registers[reg].count == 0) return;
+    
+    // Copy first: a macro may record into its own register
+    KeyList *macro = &registers[reg];
+    int *keys = malloc(macro->count * sizeof(int));
+    int count = macro->count;
+    memcpy(keys, macro->keys, count * sizeof(int));
+    
+    playing[reg] = true;
+    last_played = reg;
+    for (int i = 0; i < n; i++) game_replay_keys(game, keys, count);
+    playing[reg] = false;
+    free(keys);
+}
+
+// Repeat the last change n times
+static void game_repeat_change(Game *game, int n) {
+    if (last_change.count == 0) return;
+    
+    int *keys = malloc(last_change.count * sizeof(int));
+    int count = last_change.count;
+    memcpy(keys, last_change.keys, count * sizeof(int));
+    for (int i = 0; i < n; i++) game_replay_keys(game, keys, count);
+    free(keys);
+}
+
+// Whether the handler is waiting at the start of a normal mode command
+static bool game_at_command(Game *game) {
+    return game->mode == MODE_NORMAL && !await_callback && await_number == 0;
+}
+
+void game_handle_input(Game *game, int key) {
+    if (replay_depth > 0 || !macro_key(key)) {
+        game_dispatch_key(game, key);
+        return;
+    }
+    
+    bool at_command = game_at_command(game);
+    
+    // q at the start of a command ends a recording; it is not kept
+    if (at_command && key == 'q' && recording >= 0) {
+        recording = -1;
+        bottom_bar_recording(game->bottom_bar, 0);
+        return;
+    }
+    if (recording >= 0) key_list_add(&registers[recording], key);
+    
+    // Track the keys of the current command, and whether it edits, so a
+    // finished change can be repeated with .
+    if (at_command) {
+        change.count = 0;
+        change_edits = false;
+    }
+    if (key == 9 || key > 26) key_list_add(&change, key);
+    bool command_key = !await_callback || await_callback == game_handle_number_command;
+    if (game->mode == MODE_NORMAL && command_key &&
+        key > 0 && key < 128 && strchr("xrdciIa", key)) {
+        change_edits = true;
+    }
+    
+    game_dispatch_key(game, key);
+    
+    if (change_edits && game_at_command(game)) {
+        KeyList done = last_change;
+        last_change = change;
+        change = done;
+        change_edits = false;
+    }
+}
+
+static void game_dispatch_key(Game *game, int key) {
+    if (key == -1) { // Window resize
+        game_layout(game);
+        return;
+    }
+    
+    // Handle control keys (Tab shares its code with Ctrl+I)
+    if (key >= 1 && key <= 26 && key != 9) {
         switch (key) {
             case 3:  // Ctrl+C
                 game_exit(game);
@@ -541,6 +864,13 @@ void game_handle_input(Game *game, int key) {
             case 19: // Ctrl+S
                 game_save(game);
                 break;
+            case 20: { // Ctrl+T, hidden: write the latency report
+                const char *path = getenv("CLIPTIC_LATENCY_LOG");
+                if (latency_write(path ? path : LATENCY_DEFAULT_PATH)) {
+                    bottom_bar_status(game->bottom_bar, L"Logged!", STATUS_MESSAGE_MS);
+                }
+                break;
+            }
         }
         return;
     }
@@ -564,6 +894,19 @@ void game_handle_input(Game *game, int key) {
         return;
     }
     
+    // A bracketed paste is typed into the current answer in either mode,
+    // as one edit drawn by the next board_update
+    if (key == KEY_PASTE) {
+        size_t len;
+        const char *text = input_paste_text(&len);
+        await_callback = NULL;
+        await_number = 0;
+        board_insert_text(&game->board, text, len);
+        game->unsaved = true;
+        bottom_bar_unsaved(game->bottom_bar, true);
+        return;
+    }
+    
     // Handle mode-specific input
     if (game->mode == MODE_INSERT) {
         switch (key) {
@@ -592,10 +935,12 @@ void game_handle_input(Game *game, int key) {
             return;
         }
         
-        // If we have a pending number, handle it
+        // If we have a pending number, handle it. The callback may wait
+        // for another key in turn, as a count before @ does.
         if (await_callback) {
-            await_callback(game, key);
+            void (*callback)(Game*, int) = await_callback;
             await_callback = NULL;
+            callback(game, key);
             await_number = 0;
             return;
         }
@@ -654,10 +999,52 @@ void game_handle_input(Game *game, int key) {
             case 9: // Tab
                 board_swap_direction(&game->board);
                 break;
+            case 'q':
+                // Stopping is handled by game_handle_input
+                if (recording < 0 && replay_depth == 0) {
+                    await_callback = game_handle_record;
+                }
+                break;
+            case '@':
+                macro_count = 1;
+                await_callback = game_handle_play;
+                break;
+            case '.':
+                game_repeat_change(game, 1);
+                break;
         }
     }
 }
 
+// Command class of a key about to be handled, for the latency report
+static LatencyClass game_key_class(Game *game, int key) {
+    switch (key) {
+        case 7:  return LAT_CHECK;  // Ctrl+G
+        case 19: return LAT_SAVE;   // Ctrl+S
+        case KEY_PASTE: return LAT_INSERT;
+    }
+    if (key >= 258 && key <= 261) return LAT_MOTION;
+    
+    if (game->mode == MODE_INSERT) {
+        bool letter = (key >= 'A' && key <= 'Z') || (key >= 'a' && key <= 'z');
+        return (letter || key == 127) ? LAT_INSERT : LAT_OTHER;
+    }
+    
+    // Normal mode: r, d and c take the next key as their edit
+    if (await_callback && await_callback != game_handle_number_command) {
+        return LAT_INSERT;
+    }
+    switch (key) {
+        case 'h': case 'j': case 'k': case 'l': case 'e': case 'I': case 'a':
+            return LAT_MOTION;
+        case 'w': case 'b': case 'g': case 'G': case 9: // Tab
+            return LAT_JUMP;
+        case 'x':
+            return LAT_INSERT;
+    }
+    return LAT_OTHER;
+}
+
 static void game_handle_number_command(Game *game, int key) {
     int n = await_number > 0 ? await_number : 1;
     
@@ -686,10 +1073,17 @@ static void game_handle_number_command(Game *game, int key) {
         case 'l':
             board_move(&game->board, 0, n);
             break;
+        case '@':
+            macro_count = n;
+            await_callback = game_handle_play;
+            break;
+        case '.':
+            game_repeat_change(game, n);
+            break;
         default:
             // Not a number command, handle normally
             await_number = 0;
-            game_handle_input(game, key);
+            game_dispatch_key(game, key);
             break;
     }
 }
@@ -710,4 +1104,24 @@ static void game_handle_change(Game *game, int key) {
     game_handle_delete(game, key);
     game->mode = MODE_INSERT;
     bottom_bar_mode(game->bottom_bar, game->mode);
+}
+
+// q{a-z}: start recording into a register, replacing what it held
+static void game_handle_record(Game *game, int key) {
+    if (key < 'a' || key > 'z') return;
+    recording = key - 'a';
+    registers[recording].count = 0;
+    bottom_bar_recording(game->bottom_bar, (char)key);
+}
+
+// @{a-z} plays a register, @@ the last one played
+static void game_handle_play(Game *game, int key) {
+    int reg = -1;
+    if (key == '@') {
+        reg = last_played;
+    } else if (key >= 'a' && key <= 'z') {
+        reg = key - 'a';
+    }
+    game_play_register(game, reg, macro_count);
+    macro_count = 1;
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "puzzle.h"
 #include "windows.h"
 #include "interface.h"
+#include "cluelist.h"
 #include "database.h"
 
 // Forward declarations
@@ -15,12 +16,14 @@ typedef struct Board Board;
 typedef struct Timer Timer;
 typedef struct Cursor Cursor;
 
-// Timer structure
+// Timer structure. Elapsed time is worked out from clock_now_us when it
+// is asked for; nothing counts in the background.
 struct Timer {
-    int time;
+    unsigned long long banked_us;   // Time from earlier runs
+    unsigned long long started_us;  // When the current run began
     bool running;
+    Deadline refresh;               // Next whole second, for the top bar
     TopBar *bar;
-    void (*callback)(void);
 };
 
 // Cursor structure
@@ -34,9 +37,12 @@ struct Board {
     Puzzle *puzzle;
     Grid *grid;
     Window *cluebox;
+    ClueList *clue_list;
     Cursor *cursor;
     Clue *current_clue;
     Direction dir;
+    Clue *cluebox_clue;  // Clue the cluebox shows, and its solved state
+    bool cluebox_done;
 };
 
 // Game structure
@@ -50,10 +56,12 @@ struct Game {
     GameMode mode;
     bool continue_game;
     bool unsaved;
+    bool persist;    // Write progress, recents and scores to the database
 };
 
 // Game functions
 Game* game_new(Date date);
+Game* game_new_with(Date date, Puzzle *puzzle, GameState *state);
 void game_free(Game *game);
 void game_play(Game *game);
 void game_pause(Game *game);
@@ -63,6 +71,7 @@ void game_reset(Game *game);
 void game_reveal(Game *game);
 void game_exit(Game *game);
 void game_redraw(Game *game);
+void game_layout(Game *game);
 char* game_generate_state_json(Game *game);
 
 // Board functions
@@ -70,7 +79,9 @@ void board_setup(Board *board, GameState *state);
 void board_update(Board *board);
 void board_redraw(Board *board);
 void board_move(Board *board, int y, int x);
+void board_draw_cluebox(Board *board);
 void board_insert_char(Board *board, char ch, bool advance);
+void board_insert_text(Board *board, const char *text, size_t len);
 void board_delete_char(Board *board, bool advance);
 void board_next_clue(Board *board, int n);
 void board_prev_clue(Board *board, int n);
@@ -87,6 +98,8 @@ void board_clear_all(Board *board);
 void timer_start(Timer *timer);
 void timer_stop(Timer *timer);
 void timer_reset(Timer *timer);
+unsigned long long timer_elapsed_ms(Timer *timer);
+int timer_seconds(Timer *timer);
 
 // Cursor functions
 void cursor_set(Cursor *cursor, int y, int x);
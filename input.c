@@ -0,0 +1,301 @@
+// input.c - Terminal input decoder shared by the backends
+//
+// A small VT state machine turns raw input bytes into keys: plain bytes,
+// CSI and SS3 sequences for the cursor and editing keys with xterm
+// modifier parameters, focus reports, and bracketed paste, which arrives
+// as a single KEY_PASTE carrying the whole text.
+#include <stdlib.h>
+#include <string.h>
+#include "input.h"
+
+#define CSI_MAX 32
+
+static const char paste_end[] = "\x1b[201~";
+#define PASTE_END_LEN (sizeof(paste_end) - 1)
+
+static enum {
+    IN_GROUND,
+    IN_ESC,
+    IN_CSI,
+    IN_SS3,
+    IN_PASTE
+} state;
+
+static char csi[CSI_MAX];
+static int csi_len;
+
+// Decoded keys waiting to be read, in a ring that doubles when a burst
+// of input outruns the reader
+static InputEvent *queue;
+static int queue_cap;
+static int queue_head;
+static int queue_count;
+static int last_mods;
+
+// Paste being received, and the text handed out with KEY_PASTE
+static char *paste;
+static size_t paste_len;
+static size_t paste_cap;
+static char *pasted;
+static size_t pasted_len;
+static bool paste_queued;
+static int paste_match;    // Bytes of paste_end seen so far
+
+// Unwrap the ring into a buffer twice the size
+static bool queue_grow(void) {
+    int cap = queue_cap ? queue_cap * 2 : INPUT_QUEUE_SIZE;
+    InputEvent *grown = malloc(cap * sizeof(InputEvent));
+    if (!grown) return false;
+    
+    for (int i = 0; i < queue_count; i++) {
+        grown[i] = queue[(queue_head + i) % queue_cap];
+    }
+    free(queue);
+    queue = grown;
+    queue_cap = cap;
+    queue_head = 0;
+    return true;
+}
+
+static void emit(int key, int mods) {
+    if (queue_count == queue_cap && !queue_grow()) return;
+    InputEvent *ev = &queue[(queue_head + queue_count) % queue_cap];
+    ev->key = key;
+    ev->mods = mods;
+    queue_count++;
+}
+
+static void paste_append(const char *buf, size_t len, char **text,
+                         size_t *text_len, size_t *cap) {
+    if (*text_len + len + 1 > *cap) {
+        size_t new_cap = *cap ? *cap * 2 : 256;
+        while (new_cap < *text_len + len + 1) new_cap *= 2;
+        char *grown = realloc(*text, new_cap);
+        if (!grown) return;
+        *text = grown;
+        *cap = new_cap;
+    }
+    memcpy(*text + *text_len, buf, len);
+    *text_len += len;
+    (*text)[*text_len] = '\0';
+}
+
+// A paste is complete. Pastes that arrive before the first is read are
+// joined into one KEY_PASTE.
+static void paste_done(void) {
+    static size_t pasted_cap;
+    if (!paste_queued) pasted_len = 0;
+    paste_append(paste ? paste : "", paste_len, &pasted, &pasted_len, &pasted_cap);
+    paste_len = 0;
+    
+    if (!paste_queued) {
+        emit(KEY_PASTE, 0);
+        paste_queued = true;
+    }
+}
+
+// First and second numeric parameters of the collected CSI
+static void csi_params(int *p1, int *p2) {
+    *p1 = 0;
+    *p2 = 0;
+    int *p = p1;
+    for (int i = 0; i < csi_len; i++) {
+        if (csi[i] >= '0' && csi[i] <= '9') {
+            *p = *p * 10 + (csi[i] - '0');
+        } else if (csi[i] == ';') {
+            if (p == p2) break;
+            p = p2;
+        }
+    }
+}
+
+// Cursor keys shared by CSI and SS3 finals
+static int cursor_key(char final) {
+    switch (final) {
+        case 'A': return 259; // Up
+        case 'B': return 258; // Down
+        case 'C': return 261; // Right
+        case 'D': return 260; // Left
+        case 'H': return KEY_HOME;
+        case 'F': return KEY_END;
+    }
+    return 0;
+}
+
+static void csi_dispatch(char final) {
+    int p1, p2;
+    csi_params(&p1, &p2);
+    int mods = p2 > 1 ? p2 - 1 : 0;
+    
+    int key = cursor_key(final);
+    if (key) {
+        emit(key, mods);
+        return;
+    }
+    
+    switch (final) {
+        case 'Z':
+            emit(KEY_SHIFT_TAB, 0);
+            break;
+        case 'I':
+            emit(KEY_FOCUS_IN, 0);
+            break;
+        case 'O':
+            emit(KEY_FOCUS_OUT, 0);
+            break;
+        case '~':
+            switch (p1) {
+                case 1: case 7: emit(KEY_HOME, mods); break;
+                case 4: case 8: emit(KEY_END, mods); break;
+                case 3: emit(KEY_DELETE, mods); break;
+                case 5: emit(KEY_PAGE_UP, mods); break;
+                case 6: emit(KEY_PAGE_DOWN, mods); break;
+                case 200:
+                    paste_len = 0;
+                    paste_match = 0;
+                    state = IN_PASTE;
+                    return;
+            }
+            break;
+    }
+}
+
+static void ground(unsigned char c) {
+    switch (c) {
+        case 27:
+            state = IN_ESC;
+            break;
+        case '\r':
+            emit(10, 0);  // Enter
+            break;
+        case 8:
+            emit(127, 0); // Backspace
+            break;
+        default:
+            emit(c, 0);
+            break;
+    }
+}
+
+// Decode a run of input bytes, queueing every complete key
+void input_feed(const char *buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)buf[i];
+        
+        switch (state) {
+            case IN_GROUND:
+                ground(c);
+                break;
+            
+            case IN_ESC:
+                // Only CSI and SS3 introducers continue a sequence; any
+                // other byte after ESC is a key of its own, so a quick
+                // Esc followed by a command is never read as Alt+key
+                if (c == '[') {
+                    csi_len = 0;
+                    state = IN_CSI;
+                } else if (c == 'O') {
+                    state = IN_SS3;
+                } else {
+                    emit(27, 0);
+                    state = IN_GROUND;
+                    ground(c);
+                }
+                break;
+            
+            case IN_CSI:
+                if (c >= 0x40 && c <= 0x7E) {
+                    state = IN_GROUND;
+                    csi_dispatch((char)c);
+                } else if (c >= 0x20 && c <= 0x3F && csi_len < CSI_MAX) {
+                    csi[csi_len++] = (char)c;
+                } else {
+                    state = IN_GROUND; // Malformed or too long: drop it
+                }
+                break;
+            
+            case IN_SS3:
+                state = IN_GROUND;
+                if (cursor_key((char)c)) emit(cursor_key((char)c), 0);
+                break;
+            
+            case IN_PASTE: {
+                // Copy plain text up to the next ESC in one go
+                size_t run = 0;
+                if (paste_match == 0) {
+                    while (i + run < len && buf[i + run] != '\x1b') run++;
+                }
+                if (run > 0) {
+                    paste_append(&buf[i], run, &paste, &paste_len, &paste_cap);
+                    i += run - 1;
+                    break;
+                }
+                
+                // Match the end marker, which may span several feeds
+                if (c == (unsigned char)paste_end[paste_match]) {
+                    if (++paste_match == (int)PASTE_END_LEN) {
+                        paste_match = 0;
+                        state = IN_GROUND;
+                        paste_done();
+                    }
+                } else {
+                    // Not the marker after all: keep what it swallowed
+                    paste_append(paste_end, paste_match, &paste, &paste_len, &paste_cap);
+                    paste_match = 0;
+                    if (c == 27) {
+                        paste_match = 1;
+                    } else {
+                        paste_append(&buf[i], 1, &paste, &paste_len, &paste_cap);
+                    }
+                }
+                break;
+            }
+        }
+    }
+}
+
+// Queue a key a backend decoded itself, such as a console resize record
+void input_push(int key) {
+    emit(key, 0);
+}
+
+bool input_next(InputEvent *ev) {
+    if (queue_count == 0) return false;
+    *ev = queue[queue_head];
+    queue_head = (queue_head + 1) % queue_cap;
+    queue_count--;
+    last_mods = ev->mods;
+    if (ev->key == KEY_PASTE) paste_queued = false;
+    return true;
+}
+
+// True while an escape sequence has started but not finished; the
+// backend then waits briefly for the rest before calling input_flush
+bool input_partial(void) {
+    return state == IN_ESC || state == IN_CSI || state == IN_SS3;
+}
+
+// Give up on an unfinished sequence: a lone ESC is the Escape key
+void input_flush(void) {
+    if (state == IN_ESC) emit(27, 0);
+    if (input_partial()) state = IN_GROUND;
+}
+
+void input_reset(void) {
+    state = IN_GROUND;
+    queue_head = queue_count = 0;
+    paste_len = 0;
+    paste_match = 0;
+    paste_queued = false;
+}
+
+// Text of the most recent KEY_PASTE, valid until the next paste completes
+const char* input_paste_text(size_t *len) {
+    if (len) *len = pasted_len;
+    return pasted ? pasted : "";
+}
+
+// Modifiers held with the last key read
+int input_last_mods(void) {
+    return last_mods;
+}
@@ -0,0 +1,45 @@
+// input.h - Terminal input decoder shared by the backends
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Keys the queue holds before it first grows
+#define INPUT_QUEUE_SIZE 256
+
+// Key codes beyond the byte range, numbered like curses where it has one
+// (258-261 are the arrows)
+#define KEY_HOME 262
+#define KEY_DELETE 330
+#define KEY_PAGE_DOWN 338
+#define KEY_PAGE_UP 339
+#define KEY_SHIFT_TAB 353
+#define KEY_END 360
+#define KEY_PASTE 512      // Bracketed paste; text from input_paste_text
+#define KEY_FOCUS_IN 513
+#define KEY_FOCUS_OUT 514
+
+// Modifier bits, as xterm encodes them minus one
+#define INPUT_MOD_SHIFT 1
+#define INPUT_MOD_ALT   2
+#define INPUT_MOD_CTRL  4
+
+typedef struct {
+    int key;
+    int mods;
+} InputEvent;
+
+// Decoder functions. Backends feed whatever bytes they have and take
+// keys out one at a time; a burst of input costs one read.
+void input_feed(const char *buf, size_t len);
+void input_push(int key);
+bool input_next(InputEvent *ev);
+bool input_partial(void);
+void input_flush(void);
+void input_reset(void);
+
+const char* input_paste_text(size_t *len);
+int input_last_mods(void);
+
+#endif // INPUT_H
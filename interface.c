@@ -7,6 +7,7 @@
 #include "screen.h"
 #include "config.h"
 #include "database.h"
+#include "utf8.h"
 
 // Unicode small numbers
 const wchar_t UC_NUMS[10] = {
@@ -19,9 +20,25 @@ TopBar* top_bar_new(Date date) {
     TopBar *bar = calloc(1, sizeof(TopBar));
     window_init(&bar->window, 1, 0, 0, 0);
     bar->date = date;
+    bar->time = -1;
     return bar;
 }
 
+// Solve time at the right-hand end of the bar
+static void top_bar_draw_time(TopBar *bar) {
+    if (bar->time < 0) return;
+    
+    int lines, cols;
+    screen_get_size(&lines, &cols);
+    
+    char time_str[16];
+    snprintf(time_str, sizeof(time_str), "%02d:%02d:%02d",
+             bar->time / 3600, (bar->time % 3600) / 60, bar->time % 60);
+    console_set_color(g_colors.bar);
+    console_move_cursor(0, cols - (int)strlen(time_str) - 1);
+    console_write_utf8(time_str);
+}
+
 void top_bar_draw(TopBar *bar) {
     window_draw_bar(&bar->window, g_colors.bar);
     
@@ -33,10 +50,17 @@ void top_bar_draw(TopBar *bar) {
     // Draw date
     char date_str[64];
     date_to_long_string(bar->date, date_str, sizeof(date_str));
-    wchar_t wdate[64];
-    mbstowcs(wdate, date_str, 64);
     console_move_cursor(0, 11);
-    console_write_string(wdate);
+    console_write_utf8(date_str);
+    
+    top_bar_draw_time(bar);
+}
+
+// Show a new solve time, repainting only the time
+void top_bar_time(TopBar *bar, int seconds) {
+    if (bar->time == seconds) return;
+    bar->time = seconds;
+    top_bar_draw_time(bar);
 }
 
 void top_bar_free(TopBar *bar) {
@@ -44,12 +68,15 @@ void top_bar_free(TopBar *bar) {
 }
 
 // Bottom Bar implementation
+static void bottom_bar_status_expired(void *arg);
+
 BottomBar* bottom_bar_new(void) {
     int lines, cols;
     screen_get_size(&lines, &cols);
     
     BottomBar *bar = calloc(1, sizeof(BottomBar));
     window_init(&bar->window, 1, 0, lines - 1, 0);
+    deadline_init(&bar->status_expiry, bottom_bar_status_expired, bar);
     return bar;
 }
 
@@ -73,13 +100,56 @@ void bottom_bar_mode(BottomBar *bar, GameMode mode) {
     console_write_string(mode_str);
 }
 
-void bottom_bar_unsaved(BottomBar *bar, bool unsaved) {
+// The unsaved marker and status messages share the space after the mode;
+// a message hides the marker until it expires
+#define BOTTOM_BAR_STATUS_COL 9
+#define BOTTOM_BAR_STATUS_WIDTH 10
+
+static void bottom_bar_draw_status(BottomBar *bar) {
     console_set_color(g_colors.bar);
-    console_move_cursor(bar->window.line, 9);
-    console_write_string(unsaved ? L"| +" : L"   ");
+    console_move_cursor(bar->window.line, BOTTOM_BAR_STATUS_COL);
+    
+    wchar_t text[BOTTOM_BAR_STATUS_WIDTH + 1];
+    if (bar->status) {
+        swprintf(text, BOTTOM_BAR_STATUS_WIDTH + 1, L" %-*ls",
+                 BOTTOM_BAR_STATUS_WIDTH - 1, bar->status);
+    } else {
+        wchar_t rec[8] = L"";
+        if (bar->recording) swprintf(rec, 8, L" rec @%lc", (wchar_t)bar->recording);
+        swprintf(text, BOTTOM_BAR_STATUS_WIDTH + 1, L"%-3ls%-*ls",
+                 bar->unsaved ? L"| +" : L"", BOTTOM_BAR_STATUS_WIDTH - 3, rec);
+    }
+    console_write_string(text);
+}
+
+void bottom_bar_unsaved(BottomBar *bar, bool unsaved) {
+    bar->unsaved = unsaved;
+    bottom_bar_draw_status(bar);
+}
+
+// Show the macro register being recorded, or 0 for none
+void bottom_bar_recording(BottomBar *bar, char reg) {
+    if (bar->recording == reg) return;
+    bar->recording = reg;
+    bottom_bar_draw_status(bar);
+}
+
+// Show a message for ms milliseconds. Nothing waits for it: the event
+// loop takes it down when its deadline passes.
+void bottom_bar_status(BottomBar *bar, const wchar_t *msg, int ms) {
+    bar->status = msg;
+    deadline_arm(&bar->status_expiry, clock_now_us() + (unsigned long long)ms * 1000);
+    bottom_bar_draw_status(bar);
+}
+
+static void bottom_bar_status_expired(void *arg) {
+    BottomBar *bar = (BottomBar*)arg;
+    bar->status = NULL;
+    bottom_bar_draw_status(bar);
 }
 
 void bottom_bar_free(BottomBar *bar) {
+    deadline_cancel(&bar->status_expiry);
     free(bar);
 }
 
@@ -137,6 +207,17 @@ void menu_box_draw(MenuBox *box) {
     }
 }
 
+// Re-center the box, logo and bars for the current screen size
+void menu_box_layout(MenuBox *box) {
+    int lines, cols;
+    screen_get_size(&lines, &cols);
+    
+    window_move(&box->logo->window, (lines - 15) / 2 + 1, -1);
+    window_move(&box->window, (lines - box->window.y) / 2, -1);
+    window_init(&box->top_bar->window, 1, 0, 0, 0);
+    window_init(&box->bottom_bar->window, 1, 0, lines - 1, 0);
+}
+
 void menu_box_free(MenuBox *box) {
     if (box->top_bar) top_bar_free(box->top_bar);
     if (box->bottom_bar) bottom_bar_free(box->bottom_bar);
@@ -181,38 +262,50 @@ Selector* selector_new(const char **options, int count, int x, int line) {
     sel->options = options;
     sel->option_count = count;
     sel->cursor = 0;
+    sel->drawn_cursor = -1;
     sel->running = true;
     sel->tick = NULL;
     sel->user_data = NULL;
     return sel;
 }
 
+static void selector_draw_option(Selector *sel, int i) {
+    console_move_cursor(sel->window.line + i, sel->window.col);
+    
+    if (i == sel->cursor) {
+        console_set_color(g_colors.menu_active);
+    } else {
+        console_set_color(g_colors.menu_inactive);
+    }
+    
+    // Center the option text
+    int width = utf8_width(sel->options[i]);
+    int padding = (sel->window.x - width) / 2;
+    for (int j = 0; j < padding; j++) {
+        console_write_char(L' ');
+    }
+    
+    console_write_utf8(sel->options[i]);
+    
+    for (int j = width + padding; j < sel->window.x; j++) {
+        console_write_char(L' ');
+    }
+}
+
+// Draw every option the first time, then only the rows whose highlight
+// changed since the last draw
 void selector_draw(Selector *sel) {
     console_set_cursor_visible(false);
     
-    for (int i = 0; i < sel->option_count; i++) {
-        console_move_cursor(sel->window.line + i, sel->window.col);
-        
-        if (i == sel->cursor) {
-            console_set_color(g_colors.menu_active);
-        } else {
-            console_set_color(g_colors.menu_inactive);
-        }
-        
-        // Center the option text
-        int padding = (sel->window.x - strlen(sel->options[i])) / 2;
-        for (int j = 0; j < padding; j++) {
-            console_write_char(L' ');
-        }
-        
-        wchar_t woption[256];
-        mbstowcs(woption, sel->options[i], 256);
-        console_write_string(woption);
-        
-        for (int j = strlen(sel->options[i]) + padding; j < sel->window.x; j++) {
-            console_write_char(L' ');
+    if (sel->drawn_cursor < 0) {
+        for (int i = 0; i < sel->option_count; i++) {
+            selector_draw_option(sel, i);
         }
+    } else if (sel->drawn_cursor != sel->cursor) {
+        selector_draw_option(sel, sel->drawn_cursor);
+        selector_draw_option(sel, sel->cursor);
     }
+    sel->drawn_cursor = sel->cursor;
     
     if (sel->tick) {
         sel->tick(sel);
@@ -239,14 +332,18 @@ int selector_run(Selector *sel) {
             case 3: // Ctrl+C
                 return -1;
             case -1: // Window resize
-                screen_redraw(NULL);
-                break;
+                return -2;
         }
     }
     
     return -1;
 }
 
+// Repaint every option on the next draw, after the screen was cleared
+void selector_invalidate(Selector *sel) {
+    sel->drawn_cursor = -1;
+}
+
 void selector_free(Selector *sel) {
     free(sel);
 }
@@ -265,6 +362,8 @@ Menu* menu_new(const char **options, int count, const char *title) {
     menu->enter_callback = NULL;
     menu->back_callback = NULL;
     menu->user_data = NULL;
+    menu->drawn = false;
+    menu->frame = NULL;
     
     free(box);  // We copied the structure, so free the allocated one
     
@@ -272,8 +371,20 @@ Menu* menu_new(const char **options, int count, const char *title) {
 }
 
 int menu_choose_option(Menu *menu) {
-    menu_box_draw(&menu->menu_box);
-    int choice = selector_run(menu->selector);
+    if (!menu->drawn) {
+        menu_box_draw(&menu->menu_box);
+        selector_invalidate(menu->selector);
+        menu->drawn = true;
+    }
+    
+    int choice;
+    while ((choice = selector_run(menu->selector)) == -2) {
+        menu_layout(menu);
+    }
+    
+    if (choice >= 0) {
+        menu_save_frame(menu);
+    }
     
     if (choice >= 0 && menu->enter_callback) {
         menu->enter_callback(menu);
@@ -284,8 +395,42 @@ int menu_choose_option(Menu *menu) {
     return choice;
 }
 
+// Re-place the menu after a resize and repaint it
+void menu_layout(Menu *menu) {
+    if (screen_too_small()) {
+        interface_resizer_show();
+    }
+    
+    menu_box_layout(&menu->menu_box);
+    window_move(&menu->selector->window, menu->menu_box.window.line + 5, -1);
+    
+    screen_clear();
+    menu_box_draw(&menu->menu_box);
+    selector_invalidate(menu->selector);
+    menu->drawn = true;
+    
+    screen_snapshot_free(menu->frame);
+    menu->frame = NULL;
+}
+
+// Remember the menu as it is on screen, before handing the screen over
+void menu_save_frame(Menu *menu) {
+    screen_snapshot_free(menu->frame);
+    menu->frame = screen_snapshot();
+}
+
+// Put the menu back after a game or submenu has drawn over it. The saved
+// frame is reused as long as the screen kept its size; otherwise the menu
+// is laid out again and redrawn from scratch.
+void menu_restore(Menu *menu) {
+    if (!screen_restore(menu->frame)) {
+        menu_layout(menu);
+    }
+}
+
 void menu_free(Menu *menu) {
     if (menu->selector) selector_free(menu->selector);
+    screen_snapshot_free(menu->frame);
     menu_box_free(&menu->menu_box);
     free(menu);
 }
@@ -304,15 +449,12 @@ void stat_window_show(StatWindow *win, Date date) {
     char stats[256];
     state_get_stats_string(date, stats, sizeof(stats));
     
-    // Convert and display stats line by line
+    // Display stats line by line
     char *line = strtok(stats, "\n");
     int y = 1;
     while (line != NULL && y < 4) {
         console_move_cursor(win->window.line + y, win->window.col + 8);
-        
-        wchar_t wline[128];
-        mbstowcs(wline, line, 128);
-        console_write_string(wline);
+        console_write_utf8(line);
         
         line = strtok(NULL, "\n");
         y++;
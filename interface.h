@@ -5,6 +5,8 @@
 #include <stdbool.h>
 #include "cliptic.h"
 #include "windows.h"
+#include "screen.h"
+#include "events.h"
 
 // Forward declarations
 typedef struct Menu Menu;
@@ -14,10 +16,15 @@ typedef struct Selector Selector;
 typedef struct {
     Window window;
     Date date;
+    int time;                 // Solve time shown (s), -1 if none
 } TopBar;
 
 typedef struct {
     Window window;
+    bool unsaved;
+    char recording;           // Macro register being recorded, 0 if none
+    const wchar_t *status;    // Transient message, NULL if none
+    Deadline status_expiry;   // Takes the message down
 } BottomBar;
 
 typedef struct {
@@ -44,6 +51,7 @@ struct Selector {
     const char **options;
     int option_count;
     int cursor;
+    int drawn_cursor; // Cursor as last drawn, -1 to draw every option
     bool running;
     void (*tick)(struct Selector *sel);
     void *user_data;
@@ -57,6 +65,8 @@ struct Menu {
     void (*enter_callback)(struct Menu *menu);
     void (*back_callback)(struct Menu *menu);
     void *user_data;
+    bool drawn;
+    ScreenSnapshot *frame; // Menu as it was when an option was entered
 };
 
 // Interface functions
@@ -66,12 +76,15 @@ bool interface_yes_no_menu(const char *title, void (*yes_callback)(void));
 // Component creation
 TopBar* top_bar_new(Date date);
 void top_bar_draw(TopBar *bar);
+void top_bar_time(TopBar *bar, int seconds);
 void top_bar_free(TopBar *bar);
 
 BottomBar* bottom_bar_new(void);
 void bottom_bar_draw(BottomBar *bar);
 void bottom_bar_mode(BottomBar *bar, GameMode mode);
 void bottom_bar_unsaved(BottomBar *bar, bool unsaved);
+void bottom_bar_recording(BottomBar *bar, char reg);
+void bottom_bar_status(BottomBar *bar, const wchar_t *msg, int ms);
 void bottom_bar_free(BottomBar *bar);
 
 Logo* logo_new(int line, const wchar_t *text);
@@ -80,15 +93,20 @@ void logo_free(Logo *logo);
 
 MenuBox* menu_box_new(int y, const char *title);
 void menu_box_draw(MenuBox *box);
+void menu_box_layout(MenuBox *box);
 void menu_box_free(MenuBox *box);
 
 Selector* selector_new(const char **options, int count, int x, int line);
 void selector_draw(Selector *sel);
-int selector_run(Selector *sel);
+void selector_invalidate(Selector *sel);
+int selector_run(Selector *sel); // -1 to go back, -2 on resize
 void selector_free(Selector *sel);
 
 Menu* menu_new(const char **options, int count, const char *title);
 int menu_choose_option(Menu *menu);
+void menu_layout(Menu *menu);
+void menu_save_frame(Menu *menu);
+void menu_restore(Menu *menu);
 void menu_free(Menu *menu);
 
 // Stat window
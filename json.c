@@ -0,0 +1,329 @@
+// json.c - In-place JSON tokenizer
+//
+// One pass over the text emits a flat token array. Nothing is copied:
+// string tokens point into the text, which is unescaped where it lies
+// (an escape is never shorter than what it stands for) and terminated by
+// overwriting the closing quote. Most of a payload is string content, so
+// strings are scanned for their next quote or backslash 16 bytes at a
+// time with SSE2 where available, eight at a time otherwise.
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "json.h"
+#include "utf8.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSON_SSE2
+#endif
+
+// Bytes equal to c in an 8-byte word, as their high bits
+#define SWAR_ONES 0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+#define SWAR_MATCH(w, c) ((((w) ^ (SWAR_ONES * (c))) - SWAR_ONES) & \
+                          ~((w) ^ (SWAR_ONES * (c))) & SWAR_HIGHS)
+
+// Offset of the first quote or backslash in s, or len if there is none
+static size_t json_string_run(const char *s, size_t len) {
+    size_t i = 0;
+    
+#ifdef JSON_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i slash = _mm_set1_epi8('\\');
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                                  _mm_cmpeq_epi8(v, slash)));
+        if (mask) {
+#ifdef _MSC_VER
+            unsigned long bit;
+            _BitScanForward(&bit, (unsigned long)mask);
+            return i + bit;
+#else
+            return i + __builtin_ctz(mask);
+#endif
+        }
+    }
+#endif
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, s + i, sizeof(w));
+        if (SWAR_MATCH(w, '"') | SWAR_MATCH(w, '\\')) break;
+    }
+    while (i < len && s[i] != '"' && s[i] != '\\') i++;
+    
+    return i;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Four hex digits at s, or -1
+static long hex4(const char *s) {
+    long v = 0;
+    for (int i = 0; i < 4; i++) {
+        int d = hex_digit(s[i]);
+        if (d < 0) return -1;
+        v = v << 4 | d;
+    }
+    return v;
+}
+
+typedef struct {
+    char *p;
+    char *end;
+    JsonDoc *doc;
+} JsonParser;
+
+static int json_token_add(JsonParser *ps, JsonType type, char *text, int len) {
+    JsonDoc *doc = ps->doc;
+    if (doc->count == doc->cap) {
+        doc->cap = doc->cap ? doc->cap * 2 : 256;
+        doc->tokens = realloc(doc->tokens, doc->cap * sizeof(JsonToken));
+    }
+    JsonToken *tok = &doc->tokens[doc->count];
+    tok->type = type;
+    tok->text = text;
+    tok->len = len;
+    tok->end = doc->count + 1;
+    return doc->count++;
+}
+
+// Scan a string whose opening quote has been consumed. Runs between
+// escapes are moved down over the bytes the escapes freed.
+static bool json_scan_string(JsonParser *ps) {
+    char *start = ps->p;
+    char *out = start;
+    char *p = start;
+    
+    for (;;) {
+        size_t run = json_string_run(p, ps->end - p);
+        if (out != p) memmove(out, p, run);
+        out += run;
+        p += run;
+        if (p >= ps->end) return false;
+        
+        if (*p == '"') break;
+        
+        // Backslash
+        if (p + 1 >= ps->end) return false;
+        char c = p[1];
+        p += 2;
+        switch (c) {
+            case '"': *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '/': *out++ = '/'; break;
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case 'u': {
+                if (ps->end - p < 4) return false;
+                long cp = hex4(p);
+                if (cp < 0) return false;
+                p += 4;
+                
+                // Join a surrogate pair; a lone half becomes U+FFFD
+                if (cp >= 0xD800 && cp <= 0xDBFF && ps->end - p >= 6 &&
+                    p[0] == '\\' && p[1] == 'u') {
+                    long low = hex4(p + 2);
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        p += 6;
+                    }
+                }
+                if (cp >= 0xD800 && cp <= 0xDFFF) cp = UTF8_REPLACEMENT;
+                out += utf8_encode((unsigned int)cp, out);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    
+    *out = '\0'; // At or before the closing quote
+    json_token_add(ps, JSON_STRING, start, (int)(out - start));
+    ps->p = p + 1;
+    return true;
+}
+
+static bool json_scan_number(JsonParser *ps) {
+    char *start = ps->p;
+    char *p = start;
+    
+    if (p < ps->end && *p == '-') p++;
+    char *digits = p;
+    while (p < ps->end && ((*p >= '0' && *p <= '9') || *p == '.' ||
+                           *p == 'e' || *p == 'E' || *p == '+' || *p == '-')) {
+        p++;
+    }
+    if (p == digits || *digits < '0' || *digits > '9') return false;
+    
+    json_token_add(ps, JSON_NUMBER, start, (int)(p - start));
+    ps->p = p;
+    return true;
+}
+
+static bool json_scan_literal(JsonParser *ps, const char *word, JsonType type) {
+    size_t n = strlen(word);
+    if ((size_t)(ps->end - ps->p) < n || memcmp(ps->p, word, n) != 0) return false;
+    json_token_add(ps, type, ps->p, (int)n);
+    ps->p += n;
+    return true;
+}
+
+static void json_skip_space(JsonParser *ps) {
+    while (ps->p < ps->end &&
+           (*ps->p == ' ' || *ps->p == '\n' || *ps->p == '\r' || *ps->p == '\t')) {
+        ps->p++;
+    }
+}
+
+// What may come next inside the innermost container
+typedef enum {
+    EXPECT_VALUE,      // A value, or the close of an empty array
+    EXPECT_KEY,        // A key, or the close of an empty object
+    EXPECT_COLON,
+    EXPECT_NEXT        // A comma or the close of the container
+} JsonExpect;
+
+bool json_parse(char *text, size_t len, JsonDoc *doc) {
+    JsonParser ps = {text, text + len, doc};
+    int stack[JSON_MAX_DEPTH];
+    int depth = 0;
+    JsonExpect expect = EXPECT_VALUE;
+    bool after_comma = false;
+    
+    doc->count = 0;
+    
+    for (;;) {
+        json_skip_space(&ps);
+        if (ps.p >= ps.end) break;
+        
+        char c = *ps.p;
+        int parent = depth > 0 ? stack[depth - 1] : -1;
+        bool in_object = parent >= 0 && doc->tokens[parent].type == JSON_OBJECT;
+        
+        // Closing brackets end the innermost container
+        if (c == '}' || c == ']') {
+            bool can_close = expect == EXPECT_NEXT ||
+                             (!after_comma && expect == (in_object ? EXPECT_KEY : EXPECT_VALUE));
+            if (parent < 0 || !can_close || (c == '}') != in_object) return false;
+            doc->tokens[parent].end = doc->count;
+            depth--;
+            ps.p++;
+            expect = EXPECT_NEXT;
+            after_comma = false;
+            if (depth == 0) break;
+            continue;
+        }
+        
+        if (expect == EXPECT_NEXT) {
+            if (c != ',' || parent < 0) return false;
+            ps.p++;
+            expect = in_object ? EXPECT_KEY : EXPECT_VALUE;
+            after_comma = true;
+            continue;
+        }
+        if (expect == EXPECT_COLON) {
+            if (c != ':') return false;
+            ps.p++;
+            expect = EXPECT_VALUE;
+            continue;
+        }
+        
+        after_comma = false;
+        if (parent >= 0) doc->tokens[parent].len++;
+        
+        if (expect == EXPECT_KEY) {
+            if (c != '"') return false;
+            ps.p++;
+            if (!json_scan_string(&ps)) return false;
+            expect = EXPECT_COLON;
+            continue;
+        }
+        
+        // A value
+        bool ok = true;
+        switch (c) {
+            case '{':
+            case '[':
+                if (depth == JSON_MAX_DEPTH) return false;
+                stack[depth++] = json_token_add(&ps, c == '{' ? JSON_OBJECT : JSON_ARRAY,
+                                                ps.p, 0);
+                ps.p++;
+                expect = c == '{' ? EXPECT_KEY : EXPECT_VALUE;
+                continue;
+            case '"':
+                ps.p++;
+                ok = json_scan_string(&ps);
+                break;
+            case 't':
+                ok = json_scan_literal(&ps, "true", JSON_TRUE);
+                break;
+            case 'f':
+                ok = json_scan_literal(&ps, "false", JSON_FALSE);
+                break;
+            case 'n':
+                ok = json_scan_literal(&ps, "null", JSON_NULL);
+                break;
+            default:
+                ok = json_scan_number(&ps);
+                break;
+        }
+        if (!ok) return false;
+        expect = EXPECT_NEXT;
+        if (depth == 0) break;
+    }
+    
+    // Exactly one complete value, then only whitespace
+    json_skip_space(&ps);
+    return doc->count > 0 && depth == 0 && ps.p == ps.end;
+}
+
+void json_free(JsonDoc *doc) {
+    free(doc->tokens);
+    doc->tokens = NULL;
+    doc->count = doc->cap = 0;
+}
+
+int json_get(const JsonDoc *doc, int obj, const char *key) {
+    if (obj < 0 || doc->tokens[obj].type != JSON_OBJECT) return -1;
+    
+    int tok = obj + 1;
+    for (int i = 0; i < doc->tokens[obj].len; i += 2) {
+        int value = doc->tokens[tok].end;
+        if (strcmp(doc->tokens[tok].text, key) == 0) return value;
+        tok = doc->tokens[value].end;
+    }
+    return -1;
+}
+
+// Integers only; the puzzle payload has no use for anything else
+bool json_int(const JsonDoc *doc, int tok, int *out) {
+    if (tok < 0 || doc->tokens[tok].type != JSON_NUMBER) return false;
+    
+    const char *s = doc->tokens[tok].text;
+    int len = doc->tokens[tok].len;
+    int i = 0;
+    bool negative = s[0] == '-';
+    if (negative) i++;
+    
+    long v = 0;
+    for (; i < len; i++) {
+        if (s[i] < '0' || s[i] > '9' || v > 100000000L) return false;
+        v = v * 10 + (s[i] - '0');
+    }
+    *out = (int)(negative ? -v : v);
+    return true;
+}
+
+char* json_string(const JsonDoc *doc, int tok) {
+    if (tok < 0 || doc->tokens[tok].type != JSON_STRING) return NULL;
+    return doc->tokens[tok].text;
+}
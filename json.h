@@ -0,0 +1,47 @@
+// json.h - In-place JSON tokenizer
+#ifndef JSON_H
+#define JSON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Deepest nesting accepted
+#define JSON_MAX_DEPTH 32
+
+typedef enum {
+    JSON_OBJECT,
+    JSON_ARRAY,
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_TRUE,
+    JSON_FALSE,
+    JSON_NULL
+} JsonType;
+
+// Tokens are laid out in document order, each container followed by its
+// children; an object's children alternate key and value. Strings are
+// unescaped and NUL-terminated where they lie in the parsed text.
+typedef struct {
+    JsonType type;
+    char *text;     // Strings and numbers: first character
+    int len;        // Strings and numbers: length; containers: children
+    int end;        // Index of the first token after this one's children
+} JsonToken;
+
+typedef struct {
+    JsonToken *tokens;
+    int count;
+    int cap;
+} JsonDoc;
+
+// Tokenize text in one pass, rewriting strings in place. The text must
+// outlive the tokens.
+bool json_parse(char *text, size_t len, JsonDoc *doc);
+void json_free(JsonDoc *doc);
+
+// Value of key in the object at obj, or -1
+int json_get(const JsonDoc *doc, int obj, const char *key);
+bool json_int(const JsonDoc *doc, int tok, int *out);
+char* json_string(const JsonDoc *doc, int tok);
+
+#endif // JSON_H
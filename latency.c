@@ -0,0 +1,111 @@
+// latency.c - Keystroke latency histograms
+//
+// Each key is timed from the moment the game reads it to the moment the
+// frame showing its effect is presented, and counted in a fixed-size
+// log-linear histogram for its command class. Recording is a clock read
+// and an increment, so it stays on in normal play.
+#include <stdio.h>
+#include <string.h>
+#include "latency.h"
+#include "cliptic.h"
+
+static const char *class_names[LAT_CLASS_COUNT] = {
+    "motion", "insert", "jump", "check", "save", "other"
+};
+
+static unsigned int histograms[LAT_CLASS_COUNT][LATENCY_BUCKETS];
+static unsigned long long max_us[LAT_CLASS_COUNT];
+
+static struct {
+    LatencyClass cls;
+    unsigned long long start;
+} pending[LATENCY_PENDING];
+static int pending_count;
+
+// Bucket for a latency: exact below LATENCY_SUB, then LATENCY_SUB
+// linear steps per power of two
+static int bucket_of(unsigned long long us) {
+    if (us < LATENCY_SUB) return (int)us;
+    
+    int e = 3; // log2(LATENCY_SUB)
+    while (e < 31 && (us >> (e + 1)) != 0) e++;
+    if ((us >> (e + 1)) != 0) return LATENCY_BUCKETS - 1;
+    
+    int sub = (int)(us >> (e - 3)) - LATENCY_SUB;
+    return (e - 2) * LATENCY_SUB + sub;
+}
+
+// Smallest latency that lands in bucket i
+static unsigned long long bucket_low(int i) {
+    if (i < LATENCY_SUB) return i;
+    int e = i / LATENCY_SUB + 2;
+    return (unsigned long long)(LATENCY_SUB + i % LATENCY_SUB) << (e - 3);
+}
+
+void latency_key(LatencyClass cls) {
+    if (pending_count == LATENCY_PENDING) return;
+    pending[pending_count].cls = cls;
+    pending[pending_count].start = clock_real_us();
+    pending_count++;
+}
+
+void latency_frame_done(void) {
+    if (pending_count == 0) return;
+    
+    unsigned long long now = clock_real_us();
+    for (int i = 0; i < pending_count; i++) {
+        unsigned long long us = now - pending[i].start;
+        LatencyClass cls = pending[i].cls;
+        histograms[cls][bucket_of(us)]++;
+        if (us > max_us[cls]) max_us[cls] = us;
+    }
+    pending_count = 0;
+}
+
+void latency_reset(void) {
+    memset(histograms, 0, sizeof(histograms));
+    memset(max_us, 0, sizeof(max_us));
+    pending_count = 0;
+}
+
+// Upper edge of the bucket holding the given fraction of samples
+static unsigned long long percentile(LatencyClass cls, unsigned long total,
+                                     double fraction) {
+    unsigned long want = (unsigned long)(total * fraction + 0.5);
+    if (want == 0) want = 1;
+    
+    unsigned long seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += histograms[cls][i];
+        if (seen >= want) {
+            unsigned long long high = i + 1 < LATENCY_BUCKETS ? bucket_low(i + 1) - 1 : max_us[cls];
+            return high < max_us[cls] ? high : max_us[cls];
+        }
+    }
+    return max_us[cls];
+}
+
+// Write a summary line per class, then its non-empty buckets
+bool latency_write(const char *path) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) return false;
+    
+    fprintf(fp, "# keystroke latency, read to frame presented (us)\n");
+    fprintf(fp, "# class count p50 p90 p99 max\n");
+    for (int c = 0; c < LAT_CLASS_COUNT; c++) {
+        unsigned long total = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; i++) total += histograms[c][i];
+        if (total == 0) continue;
+        
+        fprintf(fp, "%s %lu %llu %llu %llu %llu\n", class_names[c], total,
+                percentile(c, total, 0.50), percentile(c, total, 0.90),
+                percentile(c, total, 0.99), max_us[c]);
+        for (int i = 0; i < LATENCY_BUCKETS; i++) {
+            if (histograms[c][i] == 0) continue;
+            fprintf(fp, "  %llu %u\n", bucket_low(i), histograms[c][i]);
+        }
+    }
+    
+    fclose(fp);
+    return true;
+}
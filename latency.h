@@ -0,0 +1,36 @@
+// latency.h - Keystroke latency histograms
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdbool.h>
+
+// Linear steps per power of two, and buckets per histogram: values under
+// LATENCY_SUB us get one bucket each, then every doubling up to 2^31 us
+// is split LATENCY_SUB ways (12.5% wide)
+#define LATENCY_SUB 8
+#define LATENCY_BUCKETS (30 * LATENCY_SUB)
+
+// Keys still waiting for their frame
+#define LATENCY_PENDING 64
+
+#define LATENCY_DEFAULT_PATH "cliptic-latency.txt"
+
+typedef enum {
+    LAT_MOTION,
+    LAT_INSERT,
+    LAT_JUMP,
+    LAT_CHECK,
+    LAT_SAVE,
+    LAT_OTHER,
+    LAT_CLASS_COUNT
+} LatencyClass;
+
+// Stamp a key as read, then close every stamped key once the frame that
+// shows it has been presented
+void latency_key(LatencyClass cls);
+void latency_frame_done(void);
+
+void latency_reset(void);
+bool latency_write(const char *path);
+
+#endif // LATENCY_H
@@ -53,9 +53,8 @@ int menu_main_show(void) {
                 return 0;
         }
         
-        // Redraw menu after returning
-        screen_clear();
-        menu_box_draw(&menu->menu_box);
+        // Put the menu back after returning
+        menu_restore(menu);
     }
     
     menu_free(menu);
@@ -174,11 +173,13 @@ int menu_select_date_show(void) {
                 break;
             case 10: // Enter
                 {
+                    menu_save_frame(dsm.menu);
                     Game *game = game_new(dsm.date);
                     if (game) {
                         game_play(game);
                         game_free(game);
                     }
+                    menu_restore(dsm.menu);
                 }
                 break;
             case 'q':
@@ -245,8 +246,7 @@ int menu_this_week_show(void) {
         }
         
         // Refresh menu
-        screen_clear();
-        menu_box_draw(&menu->menu_box);
+        menu_restore(menu);
     }
     
         // Show score details
@@ -308,8 +308,7 @@ int menu_recent_puzzles_show(void) {
         }
         
         // Refresh menu
-        screen_clear();
-        menu_box_draw(&menu->menu_box);
+        menu_restore(menu);
     }
     
     stat_window_free(stat_win);
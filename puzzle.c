@@ -8,6 +8,7 @@
 #include "puzzle.h"
 #include "config.h"
 #include "game.h"  // For game_generate_state_json
+#include "json.h"
 
 // If curl is not available, define minimal stubs
 #ifdef HAVE_CURL
@@ -17,6 +18,7 @@
 typedef void CURL;
 typedef int CURLcode;
 #define CURLE_OK 0
+#define CURL_GLOBAL_DEFAULT 3
 #define CURLOPT_URL 10002
 #define CURLOPT_WRITEFUNCTION 20011
 #define CURLOPT_WRITEDATA 10001
@@ -30,13 +32,16 @@ CURLcode curl_easy_setopt(CURL *curl, int option, ...) { return CURLE_OK; }
 CURLcode curl_easy_perform(CURL *curl) { return CURLE_OK; }
 #endif
 
-// For now, we'll implement a simple JSON parser or use stubs
-// In production, you would use a library like cJSON
-
 #define PUZZLE_URL "https://data.puzzlexperts.com/puzzleapp-v3/data.php"
 #define PUZZLE_PSID "100000160"
 #define CACHE_PATH "%USERPROFILE%\\.cache\\cliptic"
 
+// Largest grid accepted from a payload
+#define PUZZLE_MAX_SIZE 64
+
+// Arena space for the clues and maps of a daily grid, beyond the payload
+#define PUZZLE_ARENA_SIZE 16384
+
 // Memory callback for CURL
 struct MemoryStruct {
     char *memory;
@@ -91,6 +96,14 @@ char* fetch_puzzle_data(Date date) {
     return chunk.memory;
 }
 
+// Where the payload for date is cached
+static void cache_file_path(char *out, size_t size, Date date) {
+    char cache_dir[MAX_PATH];
+    ExpandEnvironmentStringsA(CACHE_PATH, cache_dir, MAX_PATH);
+    snprintf(out, size, "%s\\%04d-%02d-%02d",
+             cache_dir, date.year, date.month, date.day);
+}
+
 // Cache puzzle data
 bool cache_puzzle_data(Date date, const char *data) {
     char cache_dir[MAX_PATH];
@@ -98,9 +111,7 @@ bool cache_puzzle_data(Date date, const char *data) {
     
     ExpandEnvironmentStringsA(CACHE_PATH, cache_dir, MAX_PATH);
     _mkdir(cache_dir);
-    
-    snprintf(cache_file, sizeof(cache_file), "%s\\%04d-%02d-%02d",
-             cache_dir, date.year, date.month, date.day);
+    cache_file_path(cache_file, sizeof(cache_file), date);
     
     FILE *fp = fopen(cache_file, "w");
     if (!fp) return false;
@@ -113,11 +124,7 @@ bool cache_puzzle_data(Date date, const char *data) {
 // Load cached puzzle
 char* load_cached_puzzle(Date date) {
     char cache_file[MAX_PATH];
-    char temp[MAX_PATH];
-    
-    ExpandEnvironmentStringsA(CACHE_PATH, temp, MAX_PATH);
-    snprintf(cache_file, sizeof(cache_file), "%s\\%04d-%02d-%02d",
-             temp, date.year, date.month, date.day);
+    cache_file_path(cache_file, sizeof(cache_file), date);
     
     struct stat st;
     if (stat(cache_file, &st) != 0) return NULL;
@@ -131,33 +138,60 @@ char* load_cached_puzzle(Date date) {
         return NULL;
     }
     
-    fread(data, 1, st.st_size, fp);
-    data[st.st_size] = '\0';
+    // Text mode may read fewer bytes than the file holds
+    size_t len = fread(data, 1, st.st_size, fp);
+    data[len] = '\0';
     fclose(fp);
     
     return data;
 }
 
+// Drop a cached payload, so the next load fetches it again
+void remove_cached_puzzle(Date date) {
+    char cache_file[MAX_PATH];
+    cache_file_path(cache_file, sizeof(cache_file), date);
+    remove(cache_file);
+}
+
 // Clue implementation
-Clue* clue_new(const char *answer, const char *hint, Direction dir, Position start) {
-    Clue *clue = calloc(1, sizeof(Clue));
-    
+static bool hint_has_length(const char *hint) {
+    return strchr(hint, '(') && strchr(hint, ')');
+}
+
+// Write hint to out with " (length)" after it; out needs
+// strlen(hint) + HINT_LENGTH_SIZE bytes
+#define HINT_LENGTH_SIZE 16
+static void hint_add_length(char *out, const char *hint, int length) {
+    size_t len = strlen(hint);
+    memcpy(out, hint, len);
+    out += len;
+    
+    char digits[12];
+    int n = 0;
+    do {
+        digits[n++] = '0' + length % 10;
+        length /= 10;
+    } while (length > 0);
+    
+    *out++ = ' ';
+    *out++ = '(';
+    while (n > 0) *out++ = digits[--n];
+    *out++ = ')';
+    *out = '\0';
+}
+
+// Fill in a clue around storage already set aside for it
+static void clue_place(Clue *clue, Position *coords, char *answer, char *hint,
+                       Direction dir, Position start) {
     clue->length = strlen(answer);
-    clue->answer = strdup(answer);
+    clue->answer = answer;
+    clue->hint = hint;
     clue->dir = dir;
     clue->start = start;
     clue->done = false;
     
-    // Parse hint - add length if not present
-    if (strstr(hint, "(") && strstr(hint, ")")) {
-        clue->hint = strdup(hint);
-    } else {
-        clue->hint = malloc(strlen(hint) + 10);
-        sprintf(clue->hint, "%s (%d)", hint, clue->length);
-    }
-    
     // Map coordinates
-    clue->coords = calloc(clue->length, sizeof(Position));
+    clue->coords = coords;
     for (int i = 0; i < clue->length; i++) {
         if (dir == DIR_ACROSS) {
             clue->coords[i].y = start.y;
@@ -167,15 +201,52 @@ Clue* clue_new(const char *answer, const char *hint, Direction dir, Position sta
             clue->coords[i].x = start.x;
         }
     }
+}
+
+// A clue on its own, in one block with its coordinates and a copy of its
+// answer and hint
+Clue* clue_new(const char *answer, const char *hint, Direction dir, Position start) {
+    size_t length = strlen(answer);
+    size_t hint_size = strlen(hint) + HINT_LENGTH_SIZE;
+    size_t coords_at = (sizeof(Clue) + 7) & ~(size_t)7;
+    char *block = calloc(1, coords_at + length * sizeof(Position) + length + 1 + hint_size);
+    
+    Clue *clue = (Clue*)block;
+    Position *coords = (Position*)(block + coords_at);
+    char *answer_text = (char*)(coords + length);
+    char *hint_text = answer_text + length + 1;
+    
+    memcpy(answer_text, answer, length);
+    if (hint_has_length(hint)) {
+        strcpy(hint_text, hint);
+    } else {
+        hint_add_length(hint_text, hint, (int)length);
+    }
     
+    clue_place(clue, coords, answer_text, hint_text, dir, start);
     return clue;
 }
 
+// A clue in a puzzle's arena. Answer and hint are used where they are,
+// in the payload; only a hint missing its length is copied, to add it.
+Clue* clue_new_in(Arena *arena, char *answer, char *hint, Direction dir, Position start) {
+    Clue *clue = arena_alloc(arena, sizeof(Clue));
+    Position *coords = arena_alloc(arena, strlen(answer) * sizeof(Position));
+    
+    if (!hint_has_length(hint)) {
+        char *text = arena_alloc(arena, strlen(hint) + HINT_LENGTH_SIZE);
+        hint_add_length(text, hint, (int)strlen(answer));
+        hint = text;
+    }
+    
+    clue_place(clue, coords, answer, hint, dir, start);
+    return clue;
+}
+
+// Only for clues from clue_new; a puzzle's clues go with its arena
 void clue_free(Clue *clue) {
     if (clue) {
-        free(clue->answer);
-        free(clue->hint);
-        free(clue->coords);
+        layout_free(clue->hint_layout);
         free(clue);
     }
 }
@@ -186,7 +257,7 @@ void clue_activate(Clue *clue) {
     }
     for (int i = 0; i < clue->length; i++) {
         if (clue->cells[i]) {
-            cell_underline(clue->cells[i]);
+            cell_underline(clue->cells[i], true);
         }
     }
 }
@@ -197,12 +268,9 @@ void clue_deactivate(Clue *clue) {
     }
     for (int i = 0; i < clue->length; i++) {
         if (clue->cells[i]) {
-            cell_write(clue->cells[i], clue->cells[i]->buffer);
+            cell_underline(clue->cells[i], false);
         }
     }
-    if (g_config.auto_mark) {
-        clue_check(clue);
-    }
 }
 
 bool clue_has_cell(Clue *clue, int y, int x) {
@@ -215,7 +283,14 @@ bool clue_has_cell(Clue *clue, int y, int x) {
 }
 
 void clue_check(Clue *clue) {
-    if (clue_is_full(clue)) {
+    if (!clue_is_full(clue)) {
+        // Drop marks left over from before the clue was edited
+        for (int i = 0; i < clue->length; i++) {
+            if (!clue->cells[i]->locked) {
+                cell_color(clue->cells[i], g_colors.grid);
+            }
+        }
+    } else {
         bool correct = true;
         for (int i = 0; i < clue->length; i++) {
             if (clue->cells[i]->buffer != clue->answer[i]) {
@@ -276,31 +351,75 @@ const char* clue_get_meta(Clue *clue) {
 }
 
 // Puzzle implementation
-Puzzle* puzzle_new(Date date) {
-    Puzzle *puzzle = calloc(1, sizeof(Puzzle));
+static void puzzle_build(Puzzle *puzzle);
+static void puzzle_index_clues(Puzzle *puzzle);
+static void puzzle_map_clues(Puzzle *puzzle);
+static void puzzle_find_blocks(Puzzle *puzzle);
+static void puzzle_chain_clues(Puzzle *puzzle);
+
+// An empty puzzle at the start of its own arena. Everything loaded with
+// it is allocated from the arena, so it ends up laid out in load order
+// in one or two chunks and goes in one release.
+static Puzzle* puzzle_alloc(size_t size) {
+    Arena *arena = arena_new(sizeof(Puzzle) + size);
+    if (!arena) return NULL;
     
-    // Try to load from cache first
+    Puzzle *puzzle = arena_alloc(arena, sizeof(Puzzle));
+    puzzle->arena = arena;
+    return puzzle;
+}
+
+Puzzle* puzzle_new(Date date) {
+    // Try to load from cache first; an entry that no longer parses is
+    // dropped and fetched again
+    Puzzle *puzzle = NULL;
     char *data = load_cached_puzzle(date);
-    if (!data) {
-        // Fetch from server
-        data = fetch_puzzle_data(date);
-        if (!data) {
-            free(puzzle);
-            return NULL;
-        }
-        // Cache for future use
-        cache_puzzle_data(date, data);
+    if (data) {
+        puzzle = parse_puzzle_data(data, strlen(data));
+        free(data);
+        if (!puzzle) remove_cached_puzzle(date);
     }
     
-    // Parse the data
-    if (!parse_puzzle_data(data, puzzle)) {
+    if (!puzzle) {
+        // Fetch from server
+        data = fetch_puzzle_data(date);
+        if (!data) return NULL;
+        puzzle = parse_puzzle_data(data, strlen(data));
+        
+        // Cache for future use, once it is known to parse
+        if (puzzle) cache_puzzle_data(date, data);
         free(data);
-        free(puzzle);
-        return NULL;
+        if (!puzzle) return NULL;
     }
     
-    free(data);
-    
+    puzzle_build(puzzle);
+    return puzzle;
+}
+
+// Build a puzzle from clues made elsewhere; the puzzle takes ownership
+// of the clue array and the clues, moving them into its arena
+Puzzle* puzzle_new_from_clues(Position size, Clue **clues, int count) {
+    Puzzle *puzzle = puzzle_alloc(PUZZLE_ARENA_SIZE);
+    Arena *arena = puzzle->arena;
+    puzzle->size = size;
+    puzzle->clues = arena_alloc(arena, count * sizeof(Clue*));
+    puzzle->clue_count = count;
+    
+    for (int i = 0; i < count; i++) {
+        Clue *clue = clues[i];
+        puzzle->clues[i] = clue_new_in(arena, arena_strdup(arena, clue->answer),
+                                       arena_strdup(arena, clue->hint),
+                                       clue->dir, clue->start);
+        clue_free(clue);
+    }
+    free(clues);
+    
+    puzzle_build(puzzle);
+    return puzzle;
+}
+
+// Derive numbering, maps, blocks and clue order from the clue list
+static void puzzle_build(Puzzle *puzzle) {
     // Index clues
     puzzle_index_clues(puzzle);
     
@@ -312,89 +431,199 @@ Puzzle* puzzle_new(Date date) {
     
     // Chain clues
     puzzle_chain_clues(puzzle);
-    
-    return puzzle;
 }
 
 void puzzle_free(Puzzle *puzzle) {
     if (!puzzle) return;
     
-    // Free clues
+    // Hint layouts are built when drawn, outside the arena
     for (int i = 0; i < puzzle->clue_count; i++) {
-        clue_free(puzzle->clues[i]);
+        layout_free(puzzle->clues[i]->hint_layout);
     }
-    free(puzzle->clues);
     
-    // Free maps
-    if (puzzle->map_chars) {
-        for (int y = 0; y < puzzle->size.y; y++) {
-            for (int x = 0; x < puzzle->size.x; x++) {
-                free(puzzle->map_chars[y][x]);
-            }
-            free(puzzle->map_chars[y]);
+    // The puzzle itself is in the arena
+    arena_free(puzzle->arena);
+}
+
+// Payload fields
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Undo form encoding (%XX and + for space) between s and end, in place;
+// returns the new end
+static char* form_decode(char *s, char *end) {
+    char *out = s;
+    while (s < end) {
+        int hi, lo;
+        if (*s == '+') {
+            *out++ = ' ';
+            s++;
+        } else if (*s == '%' && end - s >= 3 &&
+                   (hi = hex_value(s[1])) >= 0 && (lo = hex_value(s[2])) >= 0) {
+            *out++ = (char)(hi << 4 | lo);
+            s += 3;
+        } else {
+            *out++ = *s++;
         }
-        free(puzzle->map_chars);
     }
+    return out;
+}
+
+// A non-negative decimal and nothing else
+static bool field_int(const char *s, int *out) {
+    if (!s || !*s) return false;
     
-    if (puzzle->map_index) {
-        for (int d = 0; d < 2; d++) {
-            for (int y = 0; y < puzzle->size.y; y++) {
-                free(puzzle->map_index[d][y]);
-            }
-            free(puzzle->map_index[d]);
-        }
-        free(puzzle->map_index);
+    long v = 0;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9' || v > 100000000L) return false;
+        v = v * 10 + (*s - '0');
     }
-    
-    free(puzzle->indices);
-    free(puzzle->blocks);
-    free(puzzle);
+    *out = (int)v;
+    return true;
 }
 
-// Parse puzzle data (simplified - you'll need a proper JSON parser)
-bool parse_puzzle_data(const char *data, Puzzle *puzzle) {
-    // This is a simplified parser - in reality you'd use a JSON library
-    // For now, let's assume we can extract the data somehow
-    
-    // Extract size
-    const char *rows_str = strstr(data, "rows=");
-    const char *cols_str = strstr(data, "columns=");
-    if (!rows_str || !cols_str) return false;
-    
-    sscanf(rows_str, "rows=%d", &puzzle->size.y);
-    sscanf(cols_str, "columns=%d", &puzzle->size.x);
-    
-    // Parse clues from JSON
-    // This would need a proper JSON parser implementation
-    // For now, we'll create some dummy data for testing
+// n from a key spelled prefix<n>, or -1 unless n is below count
+static int field_index(const char *key, const char *prefix, int count) {
+    size_t len = strlen(prefix);
+    int n;
+    if (strncmp(key, prefix, len) != 0 || !field_int(key + len, &n)) return -1;
+    return n < count ? n : -1;
+}
+
+// The numbered fields of one clue, as found
+typedef struct {
+    char *answer;
+    char *hint;
+    char *dir;
+    char *row;
+    char *col;
+} ClueFields;
+
+// The puzzle's form-encoded field string, where it lies in the payload.
+// The server wraps it in JSON, as cells[0].meta.data; anything else is
+// taken to be the field string itself.
+static char* payload_fields(char *text, size_t len, size_t *fields_len) {
+    size_t i = 0;
+    while (i < len && isspace((unsigned char)text[i])) i++;
+    if (i == len || text[i] != '{') {
+        *fields_len = len;
+        return text;
+    }
+    
+    JsonDoc doc = {0};
+    char *fields = NULL;
+    if (json_parse(text, len, &doc)) {
+        int cells = json_get(&doc, 0, "cells");
+        int cell = cells >= 0 && doc.tokens[cells].type == JSON_ARRAY &&
+                   doc.tokens[cells].len > 0 ? cells + 1 : -1;
+        int data = json_get(&doc, json_get(&doc, cell, "meta"), "data");
+        fields = json_string(&doc, data);
+        if (fields) *fields_len = doc.tokens[data].len;
+    }
+    json_free(&doc);
+    return fields;
+}
+
+// Parse a puzzle payload into a new puzzle, not yet built. The payload
+// is copied into the puzzle's arena and parsed there in place. The
+// puzzle itself is a string of form-encoded fields giving the grid size
+// and, numbered from 0, each clue's answer, hint, direction (a or d) and
+// the zero-based column (start_j) and row (start_k) of its first square:
+//
+//   {"cells": [{"meta": {"data": "...&rows=15&columns=15&word0=ABC&
+//       clue0=Ship%27s+officer&dir0=a&start_j0=0&start_k0=0&..."}}]}
+//
+// Fields the game has no use for are skipped. Answers and hints stay in
+// the payload, decoded where they lie; answers are upper-cased there.
+Puzzle* parse_puzzle_data(const char *data, size_t len) {
+    Puzzle *puzzle = puzzle_alloc(len + 1 + PUZZLE_ARENA_SIZE);
+    if (!puzzle) return NULL;
+    Arena *arena = puzzle->arena;
+    puzzle->payload = arena_strndup(arena, data, len);
+    
+    size_t fields_len;
+    char *p = payload_fields(puzzle->payload, len, &fields_len);
+    if (!p) {
+        puzzle_free(puzzle);
+        return NULL;
+    }
+    char *end = p + fields_len;
+    
+    // No clue can be numbered past the count of fields
+    int count = 1;
+    for (char *amp = p; (amp = memchr(amp, '&', end - amp)); amp++) count++;
+    ClueFields *fields = calloc(count, sizeof(ClueFields));
+    char *rows_text = NULL, *cols_text = NULL;
+    
+    // One walk over the fields, terminating each key and decoded value
+    // where it lies; the byte after the string is its terminator
+    while (p < end) {
+        char *amp = memchr(p, '&', end - p);
+        if (!amp) amp = end;
+        char *eq = memchr(p, '=', amp - p);
+        if (eq) {
+            char *key = p;
+            char *value = eq + 1;
+            *eq = '\0';
+            *form_decode(value, amp) = '\0';
+            
+            int i;
+            if (strcmp(key, "rows") == 0) rows_text = value;
+            else if (strcmp(key, "columns") == 0) cols_text = value;
+            else if ((i = field_index(key, "word", count)) >= 0) fields[i].answer = value;
+            else if ((i = field_index(key, "clue", count)) >= 0) fields[i].hint = value;
+            else if ((i = field_index(key, "dir", count)) >= 0) fields[i].dir = value;
+            else if ((i = field_index(key, "start_j", count)) >= 0) fields[i].col = value;
+            else if ((i = field_index(key, "start_k", count)) >= 0) fields[i].row = value;
+        }
+        p = amp + 1;
+    }
     
-    // Dummy implementation - replace with actual JSON parsing
-    puzzle->clue_count = 10; // Example
-    puzzle->clues = calloc(puzzle->clue_count, sizeof(Clue*));
+    int rows, cols;
+    bool ok = field_int(rows_text, &rows) && field_int(cols_text, &cols) &&
+              rows >= 1 && rows <= PUZZLE_MAX_SIZE && cols >= 1 && cols <= PUZZLE_MAX_SIZE;
+    if (ok) {
+        puzzle->size = pos_make(rows, cols);
+        puzzle->clues = arena_alloc(arena, count * sizeof(Clue*));
+    }
     
-    // Create some test clues
-    for (int i = 0; i < puzzle->clue_count; i++) {
-        char answer[] = "TEST";
-        char hint[64];
-        snprintf(hint, sizeof(hint), "Test clue %d", i + 1);
-        Position start = {i / 5, (i % 5) * 2};
-        Direction dir = (i % 2) ? DIR_ACROSS : DIR_DOWN;
+    for (int i = 0; ok && i < count; i++) {
+        ClueFields *f = &fields[i];
+        if (!f->answer && !f->hint && !f->dir && !f->row && !f->col) continue;
+        
+        int y, x;
+        ok = f->answer && f->answer[0] && f->hint && f->dir &&
+             field_int(f->row, &y) && field_int(f->col, &x);
+        if (!ok) break;
         
-        puzzle->clues[i] = clue_new(answer, hint, dir, start);
+        // The whole answer has to fit on the grid
+        bool across = strcmp(f->dir, "a") == 0 || strcmp(f->dir, "across") == 0;
+        bool down = strcmp(f->dir, "d") == 0 || strcmp(f->dir, "down") == 0;
+        int length = (int)strlen(f->answer);
+        ok = (across || down) &&
+             (across ? y < rows && x + length <= cols : x < cols && y + length <= rows);
+        if (!ok) break;
+        
+        for (char *c = f->answer; *c; c++) *c = toupper((unsigned char)*c);
+        puzzle->clues[puzzle->clue_count++] = clue_new_in(arena, f->answer, f->hint,
+            across ? DIR_ACROSS : DIR_DOWN, pos_make(y, x));
     }
     
-    return true;
+    free(fields);
+    if (!ok || puzzle->clue_count == 0) {
+        puzzle_free(puzzle);
+        return NULL;
+    }
+    return puzzle;
 }
 
-// Add missing static function declarations
-static void puzzle_index_clues(Puzzle *puzzle);
-static void puzzle_map_clues(Puzzle *puzzle);
-static void puzzle_find_blocks(Puzzle *puzzle);
-static void puzzle_chain_clues(Puzzle *puzzle);
-
 static void puzzle_index_clues(Puzzle *puzzle) {
     // Find unique starting positions
-    Position *starts = calloc(puzzle->clue_count, sizeof(Position));
+    Position *starts = arena_alloc(puzzle->arena, puzzle->clue_count * sizeof(Position));
     int unique_count = 0;
     
     for (int i = 0; i < puzzle->clue_count; i++) {
@@ -424,7 +653,7 @@ static void puzzle_index_clues(Puzzle *puzzle) {
     }
     
     // Assign indices
-    puzzle->indices = calloc(unique_count + 1, sizeof(int));
+    puzzle->indices = arena_alloc(puzzle->arena, (unique_count + 1) * sizeof(int));
     for (int i = 0; i < unique_count; i++) {
         for (int j = 0; j < puzzle->clue_count; j++) {
             if (puzzle->clues[j]->start.y == starts[i].y &&
@@ -433,27 +662,34 @@ static void puzzle_index_clues(Puzzle *puzzle) {
             }
         }
     }
-    
-    free(starts);
 }
 
 static void puzzle_map_clues(Puzzle *puzzle) {
-    // Allocate maps
-    puzzle->map_chars = calloc(puzzle->size.y, sizeof(char**));
-    puzzle->map_index = calloc(2, sizeof(Clue***));
-    
-    for (int y = 0; y < puzzle->size.y; y++) {
-        puzzle->map_chars[y] = calloc(puzzle->size.x, sizeof(char*));
-        for (int x = 0; x < puzzle->size.x; x++) {
-            puzzle->map_chars[y][x] = malloc(2);
-            strcpy(puzzle->map_chars[y][x], ".");
+    Arena *arena = puzzle->arena;
+    int rows = puzzle->size.y;
+    int cols = puzzle->size.x;
+    
+    // Allocate maps, each a block of squares in row order with row
+    // pointers into it
+    char *chars = arena_alloc(arena, rows * cols * 2);
+    char **char_squares = arena_alloc(arena, rows * cols * sizeof(char*));
+    puzzle->map_chars = arena_alloc(arena, rows * sizeof(char**));
+    for (int y = 0; y < rows; y++) {
+        puzzle->map_chars[y] = char_squares + y * cols;
+        for (int x = 0; x < cols; x++) {
+            char *square = chars + (y * cols + x) * 2;
+            square[0] = '.';
+            puzzle->map_chars[y][x] = square;
         }
     }
     
+    Clue **clue_squares = arena_alloc(arena, 2 * rows * cols * sizeof(Clue*));
+    Clue ***clue_rows = arena_alloc(arena, 2 * rows * sizeof(Clue**));
+    puzzle->map_index = arena_alloc(arena, 2 * sizeof(Clue***));
     for (int d = 0; d < 2; d++) {
-        puzzle->map_index[d] = calloc(puzzle->size.y, sizeof(Clue**));
-        for (int y = 0; y < puzzle->size.y; y++) {
-            puzzle->map_index[d][y] = calloc(puzzle->size.x, sizeof(Clue*));
+        puzzle->map_index[d] = clue_rows + d * rows;
+        for (int y = 0; y < rows; y++) {
+            puzzle->map_index[d][y] = clue_squares + (d * rows + y) * cols;
         }
     }
     
@@ -473,9 +709,15 @@ static void puzzle_map_clues(Puzzle *puzzle) {
 }
 
 static void puzzle_find_blocks(Puzzle *puzzle) {
-    puzzle->block_count = 0;
-    puzzle->blocks = calloc(puzzle->size.y * puzzle->size.x, sizeof(Position));
+    int count = 0;
+    for (int y = 0; y < puzzle->size.y; y++) {
+        for (int x = 0; x < puzzle->size.x; x++) {
+            if (puzzle->map_chars[y][x][0] == '.') count++;
+        }
+    }
     
+    puzzle->block_count = 0;
+    puzzle->blocks = arena_alloc(puzzle->arena, count * sizeof(Position));
     for (int y = 0; y < puzzle->size.y; y++) {
         for (int x = 0; x < puzzle->size.x; x++) {
             if (puzzle->map_chars[y][x][0] == '.') {
@@ -485,14 +727,12 @@ static void puzzle_find_blocks(Puzzle *puzzle) {
             }
         }
     }
-    
-    puzzle->blocks = realloc(puzzle->blocks, puzzle->block_count * sizeof(Position));
 }
 
 static void puzzle_chain_clues(Puzzle *puzzle) {
     // Sort clues by direction and index
-    Clue **across = calloc(puzzle->clue_count, sizeof(Clue*));
-    Clue **down = calloc(puzzle->clue_count, sizeof(Clue*));
+    Clue **across = arena_alloc(puzzle->arena, puzzle->clue_count * sizeof(Clue*));
+    Clue **down = arena_alloc(puzzle->arena, puzzle->clue_count * sizeof(Clue*));
     int across_count = 0, down_count = 0;
     
     for (int i = 0; i < puzzle->clue_count; i++) {
@@ -532,9 +772,6 @@ static void puzzle_chain_clues(Puzzle *puzzle) {
             down[i]->prev = across_count > 0 ? across[across_count - 1] : down[down_count - 1];
         }
     }
-    
-    free(across);
-    free(down);
 }
 
 Clue* puzzle_get_first_clue(Puzzle *puzzle) {
@@ -1,71 +1,72 @@
-// database.h - Database management
-#ifndef DATABASE_H
-#define DATABASE_H
+// puzzle.h - Puzzle and clue structures
+#ifndef PUZZLE_H
+#define PUZZLE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "cliptic.h"
+#include "arena.h"
+#include "windows.h"
 
-// Forward declaration
-typedef struct Game Game;
-
-// Database paths
-#define DB_DIR_PATH "%USERPROFILE%\\.config\\cliptic\\db"
-#define DB_FILE_PATH "%USERPROFILE%\\.config\\cliptic\\db\\cliptic.db"
-
-// State structure
-typedef struct {
-    Date date;
-    int time;
-    char *chars_json;
-    int n_done;
-    int n_tot;
-    int reveals;
+// Clue structure
+typedef struct Clue {
+    char *answer;
+    char *hint;
+    Direction dir;
+    Position start;
+    Position *coords;     // Grid square of each letter
+    int length;
+    int index;            // Clue number shown on the grid
     bool done;
-    bool exists;
-} GameState;
+    Cell **cells;         // Linked by game_new
+    struct Clue *next;
+    struct Clue *prev;
+    TextLayout *hint_layout; // Wrapped hint, built on first draw
+} Clue;
 
-// Recent puzzle entry
+// Puzzle structure
 typedef struct {
-    Date date;
-    Date play_date;
-    char play_time[9]; // HH:MM:SS
-} RecentEntry;
-
-// Score entry
-typedef struct {
-    Date date;
-    Date date_done;
-    char time[9]; // HH:MM:SS
-    int reveals;
-} ScoreEntry;
-
-// Database functions
-bool db_init(void);
-void db_close(void);
-
-// State functions
-GameState* state_new(Date date);
-void state_free(GameState *state);
-bool state_exists(Date date);
-bool state_save(GameState *state, Game *game);
-bool state_load(GameState *state);
-bool state_delete(Date date);
-void state_get_stats_string(Date date, char *buffer, size_t size);
+    Position size;        // Grid squares (y x x)
+    Clue **clues;
+    int clue_count;
+    int *indices;
+    char ***map_chars;    // Answer letter per square, "." for blocks
+    Clue ****map_index;   // [direction][y][x] -> clue through that square
+    Position *blocks;
+    int block_count;
+    char *payload;        // Parsed text, kept for the clues that point into it
+    Arena *arena;         // Holds the puzzle and everything loaded with it
+} Puzzle;
 
-// Recent puzzles functions
-bool recents_add(Date date);
-int recents_get_list(RecentEntry **entries, int limit);
-void recents_free_list(RecentEntry *entries, int count);
+// Data functions
+char* fetch_puzzle_data(Date date);
+bool cache_puzzle_data(Date date, const char *data);
+char* load_cached_puzzle(Date date);
+void remove_cached_puzzle(Date date);
+Puzzle* parse_puzzle_data(const char *data, size_t len);
 
-// Scores functions
-bool scores_add(Game *game);
-int scores_get_list(ScoreEntry **entries, int limit);
-void scores_free_list(ScoreEntry *entries, int count);
+// Clue functions
+Clue* clue_new(const char *answer, const char *hint, Direction dir, Position start);
+Clue* clue_new_in(Arena *arena, char *answer, char *hint, Direction dir, Position start);
+void clue_free(Clue *clue);
+void clue_activate(Clue *clue);
+void clue_deactivate(Clue *clue);
+bool clue_has_cell(Clue *clue, int y, int x);
+void clue_check(Clue *clue);
+bool clue_is_full(Clue *clue);
+void clue_clear(Clue *clue);
+void clue_reveal(Clue *clue);
+const char* clue_get_meta(Clue *clue);
 
-// Reset functions
-bool db_reset_all(void);
-bool db_reset_states(void);
-bool db_reset_scores(void);
-bool db_reset_recents(void);
+// Puzzle functions
+Puzzle* puzzle_new(Date date);
+Puzzle* puzzle_new_from_clues(Position size, Clue **clues, int count);
+void puzzle_free(Puzzle *puzzle);
+Clue* puzzle_get_first_clue(Puzzle *puzzle);
+Clue* puzzle_get_clue(Puzzle *puzzle, int y, int x, Direction dir);
+Clue* puzzle_get_clue_by_index(Puzzle *puzzle, int index, Direction dir);
+bool puzzle_is_complete(Puzzle *puzzle);
+int puzzle_count_done(Puzzle *puzzle);
+void puzzle_check_all(Puzzle *puzzle);
 
-#endif // DATABASE_H
\ No newline at end of file
+#endif // PUZZLE_H
@@ -0,0 +1,151 @@
+// render.c - Render thread implementation
+//
+// The main thread composes frames and pushes them here; the render thread
+// is the only code that writes to the terminal. The ring is lock-free: the
+// producer alone advances head and the consumer alone advances tail. A
+// counting semaphore only lets the consumer sleep while the ring is empty.
+#include <stdlib.h>
+#include "render.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#define ATOMIC_LOAD(p) InterlockedCompareExchange((p), 0, 0)
+#define ATOMIC_STORE(p, v) InterlockedExchange((p), (v))
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#define ATOMIC_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+static RenderCmd ring[RENDER_QUEUE_SIZE];
+static volatile long head; // Next slot to fill, owned by the producer
+static volatile long tail; // Next slot to drain, owned by the consumer
+static void (*write_fn)(const char *buf, size_t len);
+static bool running;
+
+#ifdef _WIN32
+static HANDLE thread;
+static HANDLE ready;
+#else
+static pthread_t thread;
+static sem_t ready;
+#endif
+
+static void render_wait(void) {
+#ifdef _WIN32
+    WaitForSingleObject(ready, INFINITE);
+#else
+    while (sem_wait(&ready) != 0) {}
+#endif
+}
+
+static void render_signal(void) {
+#ifdef _WIN32
+    ReleaseSemaphore(ready, 1, NULL);
+#else
+    sem_post(&ready);
+#endif
+}
+
+static void render_loop(void) {
+    while (1) {
+        render_wait();
+        
+        long t = tail;
+        RenderCmd cmd = ring[t & (RENDER_QUEUE_SIZE - 1)];
+        ATOMIC_STORE(&tail, t + 1);
+        
+        switch (cmd.type) {
+            case RENDER_WRITE:
+                write_fn(cmd.buf, cmd.len);
+                free(cmd.buf);
+                break;
+            case RENDER_QUIT:
+                return;
+        }
+    }
+}
+
+#ifdef _WIN32
+static unsigned __stdcall render_thread(void *arg) {
+    (void)arg;
+    render_loop();
+    return 0;
+}
+#else
+static void *render_thread(void *arg) {
+    (void)arg;
+    render_loop();
+    return NULL;
+}
+#endif
+
+bool render_start(void (*write)(const char *buf, size_t len)) {
+    write_fn = write;
+    head = tail = 0;
+    
+#ifdef _WIN32
+    ready = CreateSemaphoreA(NULL, 0, RENDER_QUEUE_SIZE, NULL);
+    if (!ready) return false;
+    thread = (HANDLE)_beginthreadex(NULL, 0, render_thread, NULL, 0, NULL);
+    if (!thread) {
+        CloseHandle(ready);
+        return false;
+    }
+#else
+    if (sem_init(&ready, 0, 0) != 0) return false;
+    if (pthread_create(&thread, NULL, render_thread, NULL) != 0) {
+        sem_destroy(&ready);
+        return false;
+    }
+#endif
+    
+    running = true;
+    return true;
+}
+
+// Drain everything queued so far, then join the thread
+void render_stop(void) {
+    if (!running) return;
+    
+    while (!render_push(RENDER_QUIT, NULL, 0)) {
+#ifdef _WIN32
+        Sleep(1);
+#else
+        sched_yield();
+#endif
+    }
+    
+#ifdef _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+    CloseHandle(ready);
+#else
+    pthread_join(thread, NULL);
+    sem_destroy(&ready);
+#endif
+    running = false;
+}
+
+bool render_running(void) {
+    return running;
+}
+
+// Queue a command without blocking. Returns false if the ring is full, in
+// which case the caller keeps ownership of buf.
+bool render_push(RenderCmdType type, char *buf, size_t len) {
+    long h = head;
+    if (h - ATOMIC_LOAD(&tail) >= RENDER_QUEUE_SIZE) return false;
+    
+    RenderCmd *cmd = &ring[h & (RENDER_QUEUE_SIZE - 1)];
+    cmd->type = type;
+    cmd->buf = buf;
+    cmd->len = len;
+    ATOMIC_STORE(&head, h + 1);
+    
+    render_signal();
+    return true;
+}
@@ -0,0 +1,28 @@
+// render.h - Render thread fed by a single-producer/single-consumer ring
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define RENDER_QUEUE_SIZE 64 // Power of two
+
+// Commands from the main thread to the render thread
+typedef enum {
+    RENDER_WRITE, // Write buf to the terminal, then free it
+    RENDER_QUIT
+} RenderCmdType;
+
+typedef struct {
+    RenderCmdType type;
+    char *buf;
+    size_t len;
+} RenderCmd;
+
+// Render thread functions
+bool render_start(void (*write)(const char *buf, size_t len));
+void render_stop(void);
+bool render_running(void);
+bool render_push(RenderCmdType type, char *buf, size_t len);
+
+#endif // RENDER_H
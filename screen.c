@@ -1,52 +1,119 @@
 // screen.c - Screen management implementation
 #include <stdio.h>
-#include <conio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "screen.h"
 #include "cliptic.h"
+#include "config.h"
 #include "interface.h"
+#include "backend.h"
+#include "render.h"
+#include "utf8.h"
+#include "events.h"
 
-static HANDLE hConsoleOut;
-static HANDLE hConsoleIn;
-static WORD originalAttributes;
-static CONSOLE_SCREEN_BUFFER_INFO csbi;
+static const ScreenBackend *backend;
+
+static void out_flush(void);
 
 // Color pair mappings
 static struct {
-    WORD attributes;
+    int fg;
+    int bg;
 } colorPairs[32];
 
+// Composed frame (back) and last presented frame (front)
+static ScreenCell *back;
+static ScreenCell *front;
+static int buf_lines;
+static int buf_cols;
+static bool front_valid;
+
+// Logical write state used by the console_* functions
+static int cur_y;
+static int cur_x;
+static int cur_color;
+static bool cur_underline;
+static bool cursor_visible;
+static bool cursor_shown;
+
+// What the terminal itself is known to show between frames: cursor
+// position (-1 if unknown) and the attributes last sent
+static int term_y = -1;
+static int term_x = -1;
+static int term_fg;
+static int term_bg;
+static bool term_underline;
+static bool attr_known;
+
+static ScreenStats stats;
+
+// Escape stream for the frame being presented
+static char *out;
+static size_t out_len;
+static size_t out_cap;
+
+static void screen_buffer_fit(void);
+
 void screen_setup(void) {
     console_init();
     console_set_colors();
     screen_redraw(NULL);
 }
 
+// Pick a backend by name ("headless", "replay" or the native one) before
+// setup
+bool screen_select_backend(const char *name) {
+    if (strcmp(name, backend_headless.name) == 0) {
+        backend = &backend_headless;
+    } else if (strcmp(name, backend_replay.name) == 0) {
+        backend = &backend_replay;
+#ifdef _WIN32
+    } else if (strcmp(name, backend_win32.name) == 0) {
+        backend = &backend_win32;
+#else
+    } else if (strcmp(name, backend_posix.name) == 0) {
+        backend = &backend_posix;
+#endif
+    } else {
+        return false;
+    }
+    return true;
+}
+
 void console_init(void) {
-    // Get console handles
-    hConsoleOut = GetStdHandle(STD_OUTPUT_HANDLE);
-    hConsoleIn = GetStdHandle(STD_INPUT_HANDLE);
-    
-    // Save original attributes
-    GetConsoleScreenBufferInfo(hConsoleOut, &csbi);
-    originalAttributes = csbi.wAttributes;
-    
-    // Set console mode
-    DWORD mode;
-    GetConsoleMode(hConsoleIn, &mode);
-    mode &= ~ENABLE_ECHO_INPUT;
-    mode &= ~ENABLE_LINE_INPUT;
-    mode |= ENABLE_VIRTUAL_TERMINAL_INPUT;
-    SetConsoleMode(hConsoleIn, mode);
-    
-    // Enable virtual terminal processing for output
-    GetConsoleMode(hConsoleOut, &mode);
-    mode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
-    SetConsoleMode(hConsoleOut, mode);
+    // CLIPTIC_SCREEN=headless renders into memory instead of the terminal
+    const char *name = getenv("CLIPTIC_SCREEN");
+    if (!backend && !(name && screen_select_backend(name))) {
+#ifdef _WIN32
+        backend = &backend_win32;
+#else
+        backend = &backend_posix;
+#endif
+    }
+    backend->init();
+    
+    // Frames go to the terminal from the render thread. Headless and
+    // replay stay synchronous so their counters are exact whenever they
+    // are read.
+    if (backend != &backend_headless && backend != &backend_replay) {
+        render_start(backend->write);
+    }
+    
+    // Allocate back and front buffers for the visible window
+    screen_buffer_fit();
     
     // Hide cursor by default
+    cursor_shown = true;
     console_set_cursor_visible(false);
 }
 
+void screen_shutdown(void) {
+    if (!backend) return;
+    render_stop();
+    out_flush();
+    backend->shutdown();
+}
+
 void console_set_colors(void) {
     // Initialize color pairs like ncurses
     for (int i = 1; i <= 8; i++) {
@@ -60,76 +127,106 @@ void console_set_colors(void) {
 void color_init_pair(int pair, int fg, int bg) {
     if (pair < 0 || pair >= 32) return;
     
-    WORD attributes = 0;
-    
-    // Map foreground colors
-    if (fg >= 0) {
-        switch (fg) {
-            case 0: break; // Black
-            case 1: attributes |= FOREGROUND_RED; break;
-            case 2: attributes |= FOREGROUND_GREEN; break;
-            case 3: attributes |= FOREGROUND_RED | FOREGROUND_GREEN; break; // Yellow
-            case 4: attributes |= FOREGROUND_BLUE; break;
-            case 5: attributes |= FOREGROUND_RED | FOREGROUND_BLUE; break; // Magenta
-            case 6: attributes |= FOREGROUND_GREEN | FOREGROUND_BLUE; break; // Cyan
-            case 7: attributes |= FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE; break; // White
-            default: attributes |= originalAttributes & 0x0F; break;
-        }
-        if (fg >= 8) attributes |= FOREGROUND_INTENSITY;
-    } else {
-        attributes |= originalAttributes & 0x0F;
-    }
-    
-    // Map background colors
-    if (bg >= 0) {
-        switch (bg) {
-            case 0: break; // Black
-            case 1: attributes |= BACKGROUND_RED; break;
-            case 2: attributes |= BACKGROUND_GREEN; break;
-            case 3: attributes |= BACKGROUND_RED | BACKGROUND_GREEN; break; // Yellow
-            case 4: attributes |= BACKGROUND_BLUE; break;
-            case 5: attributes |= BACKGROUND_RED | BACKGROUND_BLUE; break; // Magenta
-            case 6: attributes |= BACKGROUND_GREEN | BACKGROUND_BLUE; break; // Cyan
-            case 7: attributes |= BACKGROUND_RED | BACKGROUND_GREEN | BACKGROUND_BLUE; break; // White
-            default: attributes |= originalAttributes & 0xF0; break;
-        }
-        if (bg >= 8) attributes |= BACKGROUND_INTENSITY;
-    } else {
-        attributes |= originalAttributes & 0xF0;
-    }
-    
-    colorPairs[pair].attributes = attributes;
+    // Colors are 0-7 (black, red, green, yellow, blue, magenta, cyan,
+    // white), 8 and above bright, and -1 the terminal default
+    colorPairs[pair].fg = fg;
+    colorPairs[pair].bg = bg;
 }
 
-WORD color_pair_to_attributes(int pair) {
-    if (pair < 0 || pair >= 32) return originalAttributes;
-    return colorPairs[pair].attributes;
+void console_set_color(int color_pair) {
+    cur_color = color_pair;
 }
 
-void console_set_color(int color_pair) {
-    SetConsoleTextAttribute(hConsoleOut, color_pair_to_attributes(color_pair));
+int console_get_color(void) {
+    return cur_color;
+}
+
+void console_set_underline(bool underline) {
+    cur_underline = underline;
 }
 
 void console_move_cursor(int y, int x) {
-    COORD coord = {(SHORT)x, (SHORT)y};
-    SetConsoleCursorPosition(hConsoleOut, coord);
+    cur_y = y;
+    cur_x = x;
 }
 
 void console_set_cursor_visible(bool visible) {
-    CONSOLE_CURSOR_INFO cci;
-    GetConsoleCursorInfo(hConsoleOut, &cci);
-    cci.bVisible = visible;
-    SetConsoleCursorInfo(hConsoleOut, &cci);
+    cursor_visible = visible;
+}
+
+// Columns a stored glyph takes; zero for the tail of a wide glyph
+static int glyph_width(wchar_t ch) {
+    if (ch >= 0x20 && ch < 0x300) return 1;
+    return utf8_cp_width((unsigned int)ch);
+}
+
+// Store a glyph of the given width at the cursor and advance it.
+// Overwriting either half of a wide glyph blanks the other half, so the
+// back buffer never holds a split pair.
+static void back_put(wchar_t ch, int width) {
+    if (cur_y >= 0 && cur_y < buf_lines && cur_x >= 0 && cur_x < buf_cols) {
+        ScreenCell *row = &back[cur_y * buf_cols];
+        int x = cur_x;
+        
+        // A wide glyph that does not fit before the edge is shown blank
+        if (width == 2 && x + 1 >= buf_cols) {
+            ch = L' ';
+            width = 1;
+        }
+        
+        if (row[x].ch == SCREEN_WIDE_TAIL && x > 0) {
+            row[x - 1].ch = L' ';
+        }
+        int end = x + width;
+        if (end < buf_cols && row[end].ch == SCREEN_WIDE_TAIL) {
+            row[end].ch = L' ';
+        }
+        
+        row[x].ch = ch;
+        row[x].color = cur_color;
+        row[x].underline = cur_underline;
+        if (width == 2) {
+            row[x + 1].ch = SCREEN_WIDE_TAIL;
+            row[x + 1].color = cur_color;
+            row[x + 1].underline = cur_underline;
+        }
+    }
+    cur_x += width;
 }
 
 void console_write_char(wchar_t ch) {
-    DWORD written;
-    WriteConsoleW(hConsoleOut, &ch, 1, &written, NULL);
+    int width = glyph_width(ch);
+    if (width > 0) back_put(ch, width);
+}
+
+// Write UTF-8 text straight into the back buffer. Combining marks have
+// no cell of their own and are dropped; code points a wchar_t cannot
+// hold show as U+FFFD.
+void console_write_utf8(const char *str) {
+    size_t len = strlen(str);
+    size_t i = 0;
+    
+    while (i < len) {
+        size_t run = utf8_ascii_run(str + i, len - i);
+        for (size_t j = 0; j < run; j++) {
+            if ((unsigned char)str[i + j] >= 0x20) back_put((wchar_t)str[i + j], 1);
+        }
+        i += run;
+        if (i >= len) break;
+        
+        unsigned int cp;
+        i += utf8_decode(str + i, len - i, &cp);
+        int width = utf8_cp_width(cp);
+        if (width == 0) continue;
+        if (sizeof(wchar_t) < 4 && cp > 0xFFFF) cp = UTF8_REPLACEMENT;
+        back_put((wchar_t)cp, width);
+    }
 }
 
 void console_write_string(const wchar_t *str) {
-    DWORD written;
-    WriteConsoleW(hConsoleOut, str, wcslen(str), &written, NULL);
+    while (*str) {
+        console_write_char(*str++);
+    }
 }
 
 void console_write_string_at(int y, int x, const wchar_t *str) {
@@ -138,24 +235,382 @@ void console_write_string_at(int y, int x, const wchar_t *str) {
 }
 
 void screen_clear(void) {
-    COORD topLeft = {0, 0};
-    DWORD written;
-    GetConsoleScreenBufferInfo(hConsoleOut, &csbi);
-    FillConsoleOutputCharacterW(hConsoleOut, L' ', csbi.dwSize.X * csbi.dwSize.Y, topLeft, &written);
-    FillConsoleOutputAttribute(hConsoleOut, originalAttributes, csbi.dwSize.X * csbi.dwSize.Y, topLeft, &written);
-    SetConsoleCursorPosition(hConsoleOut, topLeft);
+    for (int i = 0; i < buf_lines * buf_cols; i++) {
+        back[i].ch = L' ';
+        back[i].color = CP_DEFAULT;
+        back[i].underline = false;
+    }
+    console_move_cursor(0, 0);
+}
+
+// Copy a prerendered run of cells into the back buffer
+void screen_blit(int y, int x, const ScreenCell *cells, int n) {
+    if (y < 0 || y >= buf_lines) return;
+    if (x < 0) {
+        cells -= x;
+        n += x;
+        x = 0;
+    }
+    if (x + n > buf_cols) n = buf_cols - x;
+    if (n <= 0) return;
+    memcpy(&back[y * buf_cols + x], cells, n * sizeof(ScreenCell));
+}
+
+// Copy the composed frame so it can be put back later without redrawing
+ScreenSnapshot* screen_snapshot(void) {
+    ScreenSnapshot *snap = calloc(1, sizeof(ScreenSnapshot));
+    size_t size = buf_lines * buf_cols * sizeof(ScreenCell);
+    snap->lines = buf_lines;
+    snap->cols = buf_cols;
+    snap->cells = malloc(size);
+    memcpy(snap->cells, back, size);
+    return snap;
+}
+
+// Put a snapshot back into the composed frame. Fails if the screen has
+// been resized since, in which case the caller must lay out and redraw.
+// The next present sends only the cells that differ from the terminal.
+bool screen_restore(const ScreenSnapshot *snap) {
+    if (!snap || snap->lines != buf_lines || snap->cols != buf_cols) {
+        return false;
+    }
+    memcpy(back, snap->cells, buf_lines * buf_cols * sizeof(ScreenCell));
+    return true;
+}
+
+void screen_snapshot_free(ScreenSnapshot *snap) {
+    if (!snap) return;
+    free(snap->cells);
+    free(snap);
+}
+
+// Forget what the terminal shows so the next present repaints everything
+void screen_invalidate(void) {
+    front_valid = false;
+    term_y = term_x = -1;
+    attr_known = false;
+}
+
+// Resize both buffers to the visible window, keeping the overlapping
+// part of the composed frame. The front buffer is invalidated so the
+// next present repaints everything. This is the only place the terminal
+// size is queried; everyone else reads the cached buf_lines/buf_cols.
+static void screen_buffer_fit(void) {
+    int lines, cols;
+    backend->get_size(&lines, &cols);
+    if (lines == buf_lines && cols == buf_cols && back) return;
+    
+    ScreenCell *new_back = malloc(lines * cols * sizeof(ScreenCell));
+    for (int y = 0; y < lines; y++) {
+        for (int x = 0; x < cols; x++) {
+            ScreenCell *cell = &new_back[y * cols + x];
+            if (back && y < buf_lines && x < buf_cols) {
+                *cell = back[y * buf_cols + x];
+            } else {
+                cell->ch = L' ';
+                cell->color = CP_DEFAULT;
+                cell->underline = false;
+            }
+        }
+    }
+    
+    free(back);
+    free(front);
+    back = new_back;
+    front = malloc(lines * cols * sizeof(ScreenCell));
+    buf_lines = lines;
+    buf_cols = cols;
+    screen_invalidate();
+}
+
+// Escape stream helpers
+static void out_reserve(size_t n) {
+    if (out_len + n <= out_cap) return;
+    size_t cap = out_cap ? out_cap : 4096;
+    while (cap < out_len + n) cap *= 2;
+    out = realloc(out, cap);
+    out_cap = cap;
+}
+
+static void out_bytes(const char *bytes, size_t n) {
+    out_reserve(n);
+    memcpy(out + out_len, bytes, n);
+    out_len += n;
+}
+
+static void out_str(const char *str) {
+    out_bytes(str, strlen(str));
+}
+
+// Hand the escape stream to the render thread, or write it directly when
+// there is none. If the ring is full the bytes stay queued here and the
+// next frame is appended to them.
+static void out_flush(void) {
+    if (out_len == 0) return;
+    
+    if (render_running()) {
+        if (!render_push(RENDER_WRITE, out, out_len)) return;
+        out = NULL;
+        out_len = 0;
+        out_cap = 0;
+    } else {
+        backend->write(out, out_len);
+        out_len = 0;
+    }
+}
+
+static void out_wchar(wchar_t ch) {
+    char buf[4];
+    out_bytes(buf, utf8_encode((unsigned int)ch, buf));
+}
+
+// Map a color index (0-7 normal, 8-15 bright) to an SGR parameter
+static int sgr_color(int color, int base, int bright_base) {
+    if (color < 0) return base + 9;
+    if (color >= 8) return bright_base + (color - 8);
+    return base + color;
+}
+
+static void pair_sgr(int pair, int *fg, int *bg) {
+    if (pair <= 0 || pair >= 32) {
+        *fg = 39;
+        *bg = 49;
+        return;
+    }
+    *fg = sgr_color(colorPairs[pair].fg, 30, 90);
+    *bg = sgr_color(colorPairs[pair].bg, 40, 100);
+}
+
+// Cost of a raw cursor motion from (term_y, term_x) to (y, x). Writes the
+// cheapest escape sequence into seq and returns its length. Chooses between
+// relative moves (CUU/CUD/CUF/CUB), carriage return, column-absolute (CHA)
+// and full absolute (CUP), like curses' mvcur.
+static int seq_num(char *seq, int n, char final) {
+    if (n == 1) return sprintf(seq, "\x1b[%c", final);
+    return sprintf(seq, "\x1b[%d%c", n, final);
+}
+
+static int seq_column(char *seq, int from_x, int x) {
+    char alt[32];
+    int len, alt_len;
+    
+    if (x == from_x) {
+        seq[0] = '\0';
+        return 0;
+    }
+    
+    // Relative
+    len = x > from_x ? seq_num(seq, x - from_x, 'C') : seq_num(seq, from_x - x, 'D');
+    
+    // Carriage return, then forward
+    alt[0] = '\r';
+    alt[1] = '\0';
+    alt_len = 1 + (x > 0 ? seq_num(alt + 1, x, 'C') : 0);
+    if (alt_len < len) {
+        memcpy(seq, alt, alt_len + 1);
+        len = alt_len;
+    }
+    
+    // Column absolute
+    alt_len = x > 0 ? sprintf(alt, "\x1b[%dG", x + 1) : sprintf(alt, "\x1b[G");
+    if (alt_len < len) {
+        memcpy(seq, alt, alt_len + 1);
+        len = alt_len;
+    }
+    return len;
+}
+
+static int seq_motion(char *seq, int y, int x) {
+    char alt[64];
+    int len, alt_len;
+    
+    // Absolute
+    if (y == 0 && x == 0) len = sprintf(seq, "\x1b[H");
+    else if (x == 0) len = sprintf(seq, "\x1b[%dH", y + 1);
+    else len = sprintf(seq, "\x1b[%d;%dH", y + 1, x + 1);
+    
+    if (term_y < 0) return len;
+    
+    // Relative: vertical first, then the best horizontal move on that row
+    alt_len = 0;
+    if (y < term_y) alt_len = seq_num(alt, term_y - y, 'A');
+    else if (y > term_y) alt_len = seq_num(alt, y - term_y, 'B');
+    alt_len += seq_column(alt + alt_len, term_x, x);
+    if (alt_len < len) {
+        memcpy(seq, alt, alt_len + 1);
+        len = alt_len;
+    }
+    return len;
+}
+
+static void out_move(int y, int x) {
+    if (y == term_y && x == term_x) return;
+    
+    char seq[64];
+    int len = seq_motion(seq, y, x);
+    
+    // Forward on the same row: reprinting the skipped cells can be cheaper
+    // than any escape, if they are plain ASCII in the current attributes
+    int gap = x - term_x;
+    if (y == term_y && gap > 0 && gap < len && attr_known) {
+        bool reprint = true;
+        for (int i = term_x; i < x && reprint; i++) {
+            ScreenCell *cell = &front[y * buf_cols + i];
+            int fg, bg;
+            pair_sgr(cell->color, &fg, &bg);
+            reprint = cell->ch >= 0x20 && cell->ch < 0x80 &&
+                      fg == term_fg && bg == term_bg &&
+                      cell->underline == term_underline;
+        }
+        if (reprint) {
+            for (int i = term_x; i < x; i++) {
+                char ch = (char)front[y * buf_cols + i].ch;
+                out_bytes(&ch, 1);
+            }
+            term_x = x;
+            return;
+        }
+    }
+    
+    out_bytes(seq, len);
+    term_y = y;
+    term_x = x;
+}
+
+// Switch attributes, sending only the SGR parameters that changed unless
+// a full reset is shorter
+static void out_attr(int pair, bool underline) {
+    int fg, bg;
+    pair_sgr(pair, &fg, &bg);
+    if (attr_known && fg == term_fg && bg == term_bg && underline == term_underline) {
+        return;
+    }
+    
+    char seq[32], alt[32];
+    int len = sprintf(seq, "\x1b[0%s", underline ? ";4" : "");
+    if (fg != 39) len += sprintf(seq + len, ";%d", fg);
+    if (bg != 49) len += sprintf(seq + len, ";%d", bg);
+    seq[len++] = 'm';
+    seq[len] = '\0';
+    
+    if (attr_known) {
+        int alt_len = sprintf(alt, "\x1b[");
+        if (underline != term_underline) alt_len += sprintf(alt + alt_len, "%s;", underline ? "4" : "24");
+        if (fg != term_fg) alt_len += sprintf(alt + alt_len, "%d;", fg);
+        if (bg != term_bg) alt_len += sprintf(alt + alt_len, "%d;", bg);
+        alt[alt_len - 1] = 'm';
+        if (alt_len < len) {
+            memcpy(seq, alt, alt_len + 1);
+            len = alt_len;
+        }
+    }
+    
+    out_bytes(seq, len);
+    term_fg = fg;
+    term_bg = bg;
+    term_underline = underline;
+    attr_known = true;
+}
+
+// What an unoptimized writer would spend on a cell: an absolute move and
+// a full attribute reset per glyph
+static size_t naive_cost(int y, int x, ScreenCell *cell) {
+    char seq[64];
+    int fg, bg;
+    pair_sgr(cell->color, &fg, &bg);
+    int len = sprintf(seq, "\x1b[%d;%dH\x1b[0;%s%d;%dm", y + 1, x + 1,
+                      cell->underline ? "4;" : "", fg, bg);
+    char glyph[4];
+    return len + utf8_encode((unsigned int)cell->ch, glyph);
+}
+
+void screen_present(void) {
+    // Bracket the frame in a synchronized update so it lands in one paint
+    static const char sync_begin[] = "\x1b[?2026h";
+    static const char sync_end[] = "\x1b[?2026l";
+    size_t start = out_len; // Nonzero if the last frame is still queued
+    out_str(sync_begin);
+    
+    for (int y = 0; y < buf_lines; y++) {
+        for (int x = 0; x < buf_cols; x++) {
+            ScreenCell *b = &back[y * buf_cols + x];
+            ScreenCell *f = &front[y * buf_cols + x];
+            
+            // A wide glyph and its tail change and are written together
+            int width = glyph_width(b->ch);
+            bool wide = width == 2 && x + 1 < buf_cols &&
+                        b[1].ch == SCREEN_WIDE_TAIL;
+            
+            if (front_valid && b->ch == f->ch && b->color == f->color &&
+                b->underline == f->underline &&
+                (!wide || (f[1].ch == SCREEN_WIDE_TAIL &&
+                           b[1].color == f[1].color &&
+                           b[1].underline == f[1].underline))) {
+                continue;
+            }
+            
+            stats.cells++;
+            stats.naive_bytes += naive_cost(y, x, b);
+            
+            out_move(y, x);
+            out_attr(b->color, b->underline);
+            // Anything that would not advance exactly one column (or two,
+            // for a whole wide pair) is shown blank to keep columns aligned
+            out_wchar(wide || width == 1 ? b->ch : L' ');
+            *f = *b;
+            if (wide) {
+                f[1] = b[1];
+                term_x++;
+                x++;
+            }
+            
+            // Writing the last column leaves the cursor in a pending-wrap
+            // state that terminals disagree on, so forget where it is
+            term_x++;
+            if (term_x >= buf_cols) term_y = term_x = -1;
+        }
+    }
+    front_valid = true;
+    
+    if (cursor_visible && cur_y >= 0 && cur_y < buf_lines && 
+        cur_x >= 0 && cur_x < buf_cols) {
+        out_move(cur_y, cur_x);
+    }
+    if (cursor_visible != cursor_shown) {
+        out_str(cursor_visible ? "\x1b[?25h" : "\x1b[?25l");
+        cursor_shown = cursor_visible;
+    }
+    
+    if (out_len > start + sizeof(sync_begin) - 1) {
+        out_str(sync_end);
+        stats.frames++;
+        stats.bytes += out_len - start;
+    } else {
+        out_len = start;
+    }
+    out_flush();
+}
+
+void screen_get_stats(ScreenStats *out_stats) {
+    *out_stats = stats;
+}
+
+void screen_reset_stats(void) {
+    memset(&stats, 0, sizeof(stats));
 }
 
 bool screen_too_small(void) {
     int lines, cols;
     screen_get_size(&lines, &cols);
+    if (g_config.compact) {
+        return lines < GRID_MIN_HEIGHT_COMPACT || cols < GRID_MIN_WIDTH_COMPACT;
+    }
     return lines < GRID_MIN_HEIGHT || cols < GRID_MIN_WIDTH;
 }
 
 void screen_get_size(int *lines, int *cols) {
-    GetConsoleScreenBufferInfo(hConsoleOut, &csbi);
-    *cols = csbi.srWindow.Right - csbi.srWindow.Left + 1;
-    *lines = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+    *lines = buf_lines;
+    *cols = buf_cols;
 }
 
 void screen_redraw(void (*callback)(void)) {
@@ -166,53 +621,97 @@ void screen_redraw(void (*callback)(void)) {
     if (callback) callback();
 }
 
-int console_get_key(void) {
-    INPUT_RECORD inputRecord;
-    DWORD events;
+// Read from the backend, folding a burst of resize events into one.
+// After the first resize, further ones are swallowed until the terminal
+// has been quiet for RESIZE_DEBOUNCE_MS; a key that ends the burst is
+// held back for the next read. Returns -1 once per burst.
+#define RESIZE_DEBOUNCE_MS 50
+
+static int pending_key = BACKEND_TIMEOUT;
+
+// Sees every key handed to the program, for session recording
+static void (*key_observer)(int key);
+
+void screen_set_key_observer(void (*observer)(int key)) {
+    key_observer = observer;
+}
+
+static int screen_read_key(int timeout_ms) {
+    int key;
+    
+    if (pending_key != BACKEND_TIMEOUT) {
+        key = pending_key;
+        pending_key = BACKEND_TIMEOUT;
+        return key;
+    }
+    
+    key = backend->read_key(timeout_ms);
+    if (key != -1) return key;
+    
+    while ((key = backend->read_key(RESIZE_DEBOUNCE_MS)) == -1) {}
+    pending_key = key;
+    screen_buffer_fit();
+    return -1;
+}
+
+// Wait up to timeout_ms (< 0 for no limit) for a key, running deadlines
+// and posted work as they fall due. The only sleep is the backend's own
+// wait, bounded by the nearest deadline, so an idle screen with nothing
+// scheduled never wakes up. If present is set, frames changed by the
+// callbacks are shown straight away.
+static int screen_wait_key(int timeout_ms, bool present) {
+    unsigned long long end = 0;
+    if (timeout_ms >= 0) end = clock_now_us() + (unsigned long long)timeout_ms * 1000;
     
     while (1) {
-        ReadConsoleInput(hConsoleIn, &inputRecord, 1, &events);
+        // Callbacks draw wherever they need to; the cursor and attributes
+        // the caller left are put back so the visible cursor stays put
+        int y = cur_y, x = cur_x, color = cur_color;
+        bool underline = cur_underline;
+        if (events_dispatch()) {
+            cur_y = y;
+            cur_x = x;
+            cur_color = color;
+            cur_underline = underline;
+            if (present) screen_present();
+        }
         
-        if (inputRecord.EventType == KEY_EVENT && inputRecord.Event.KeyEvent.bKeyDown) {
-            WORD vk = inputRecord.Event.KeyEvent.wVirtualKeyCode;
-            CHAR ch = inputRecord.Event.KeyEvent.uChar.AsciiChar;
-            DWORD state = inputRecord.Event.KeyEvent.dwControlKeyState;
-            
-            // Handle special keys
-            if (vk == VK_UP) return 259;
-            if (vk == VK_DOWN) return 258;
-            if (vk == VK_LEFT) return 260;
-            if (vk == VK_RIGHT) return 261;
-            if (vk == VK_BACK) return 127;
-            if (vk == VK_RETURN) return 10;
-            if (vk == VK_ESCAPE) return 27;
-            if (vk == VK_TAB) return 9;
-            
-            // Handle Ctrl+key combinations
-            if (state & (LEFT_CTRL_PRESSED | RIGHT_CTRL_PRESSED)) {
-                if (ch >= 1 && ch <= 26) return ch;
-            }
-            
-            // Regular characters
-            if (ch > 0) return ch;
+        int wait = -1;
+        if (timeout_ms >= 0) {
+            unsigned long long now = clock_now_us();
+            wait = now >= end ? 0 : (int)((end - now + 999) / 1000);
         }
         
-        // Handle window resize
-        if (inputRecord.EventType == WINDOW_BUFFER_SIZE_EVENT) {
-            return -1; // Special code for resize
+        int key = screen_read_key(events_timeout(wait));
+        if (key == BACKEND_WAKE) continue;
+        if (key != BACKEND_TIMEOUT) {
+            if (key_observer) key_observer(key);
+            return key;
         }
+        if (timeout_ms >= 0 && clock_now_us() >= end) return BACKEND_TIMEOUT;
     }
 }
 
+// Cut the current key wait short from another thread
+void screen_wake(void) {
+    if (backend && backend->wake) backend->wake();
+}
+
+int console_get_key(void) {
+    // Flush the composed frame before blocking for input
+    screen_present();
+    return screen_wait_key(-1, true);
+}
+
+// Read a key without presenting first. Returns -2 if none arrives
+// within timeout_ms, so callers can drain queued input before drawing.
+int console_poll_key(int timeout_ms) {
+    return screen_wait_key(timeout_ms, false);
+}
+
 int console_get_key_timeout(int timeout_ms) {
-    DWORD start = GetTickCount();
-    
-    while (GetTickCount() - start < timeout_ms) {
-        if (_kbhit()) {
-            return console_get_key();
-        }
-        Sleep(10);
-    }
+    screen_present();
     
-    return -1; // Timeout
+    int key = screen_wait_key(timeout_ms, true);
+    return key == BACKEND_TIMEOUT ? -1 : key; // -1 on timeout
 }
\ No newline at end of file
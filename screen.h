@@ -2,8 +2,33 @@
 #ifndef SCREEN_H
 #define SCREEN_H
 
-#include <windows.h>
 #include <stdbool.h>
+#include <wchar.h>
+
+// Back buffer cell: what should be on screen at one position. A wide
+// glyph is followed by a SCREEN_WIDE_TAIL cell covering its second column.
+#define SCREEN_WIDE_TAIL 0
+
+typedef struct {
+    wchar_t ch;
+    int color;
+    bool underline;
+} ScreenCell;
+
+// Copy of the composed frame, for screens that are put back unchanged
+typedef struct {
+    int lines;
+    int cols;
+    ScreenCell *cells;
+} ScreenSnapshot;
+
+// Output counters, accumulated across presents
+typedef struct {
+    unsigned long frames;      // Presents that wrote anything
+    unsigned long cells;       // Cells that changed
+    unsigned long long bytes;  // Bytes sent to the terminal
+    unsigned long long naive_bytes; // Absolute move + full SGR per cell
+} ScreenStats;
 
 // Screen functions
 void screen_setup(void);
@@ -11,6 +36,16 @@ void screen_clear(void);
 bool screen_too_small(void);
 void screen_redraw(void (*callback)(void));
 void screen_get_size(int *lines, int *cols);
+void screen_present(void);
+void screen_invalidate(void);
+void screen_blit(int y, int x, const ScreenCell *cells, int n);
+ScreenSnapshot* screen_snapshot(void);
+bool screen_restore(const ScreenSnapshot *snap);
+void screen_snapshot_free(ScreenSnapshot *snap);
+void screen_get_stats(ScreenStats *stats);
+void screen_reset_stats(void);
+void screen_shutdown(void);
+bool screen_select_backend(const char *name);
 
 // Console functions
 void console_init(void);
@@ -18,16 +53,21 @@ void console_set_colors(void);
 void console_set_cursor_visible(bool visible);
 void console_move_cursor(int y, int x);
 void console_set_color(int color_pair);
+int console_get_color(void);
+void console_set_underline(bool underline);
 void console_write_char(wchar_t ch);
 void console_write_string(const wchar_t *str);
 void console_write_string_at(int y, int x, const wchar_t *str);
+void console_write_utf8(const char *str);
 
 // Input functions
 int console_get_key(void);
 int console_get_key_timeout(int timeout_ms);
+int console_poll_key(int timeout_ms);
+void screen_wake(void);
+void screen_set_key_observer(void (*observer)(int key));
 
 // Color management
 void color_init_pair(int pair, int fg, int bg);
-WORD color_pair_to_attributes(int pair);
 
 #endif // SCREEN_H
\ No newline at end of file
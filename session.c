@@ -0,0 +1,384 @@
+// session.c - Recorded input sessions and headless replay
+//
+// A session file is plain text: a header giving everything the game
+// started from (the puzzle, the solve timer's starting value, the
+// terminal size, the settings that change how it plays and the saved
+// board, if any), then one line per key as the game read it, stamped
+// with microseconds since the session started. Pastes and the saved
+// board are in hex.
+//
+//   cliptic-session 2
+//   date 2024-05-01
+//   time 0
+//   size 40 80
+//   set auto_advance 1
+//   set auto_mark 1
+//   set max_fps 60
+//   set compact 0
+//   chars 5b7b2273...
+//   1520344 key 105
+//   2013377 paste 534849504d415445
+//
+// Replay restores that starting point and feeds the keys back at their
+// recorded times on a virtual clock. Deadlines, the solve timer and frame
+// pacing all run on that clock, so they see exactly the recorded timeline
+// however fast the replay runs. Settings the header leaves out keep their
+// defaults, and replays never write to the database.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "session.h"
+#include "backend.h"
+#include "screen.h"
+#include "input.h"
+#include "config.h"
+#include "database.h"
+#include "game.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Where the virtual clock starts; deadlines treat time 0 as unset
+#define SESSION_CLOCK_BASE 1000000ULL
+
+typedef struct {
+    unsigned long long at;  // us since the session started
+    int key;
+    char *text;             // Paste text, for KEY_PASTE
+    size_t text_len;
+} SessionEvent;
+
+// Recording
+static FILE *record_fp;
+static unsigned long long record_start;
+
+static void write_hex(const char *text, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        fprintf(record_fp, "%02x", (unsigned char)text[i]);
+    }
+    fputc('\n', record_fp);
+}
+
+static void record_key(int key) {
+    unsigned long long at = clock_now_us() - record_start;
+    
+    if (key == KEY_PASTE) {
+        size_t len;
+        const char *text = input_paste_text(&len);
+        fprintf(record_fp, "%llu paste ", at);
+        write_hex(text, len);
+    } else {
+        fprintf(record_fp, "%llu key %d\n", at, key);
+    }
+}
+
+bool session_record_start(const char *path, Game *game) {
+    record_fp = fopen(path, "w");
+    if (!record_fp) return false;
+    
+    char date_str[11];
+    date_to_string(game->date, date_str, sizeof(date_str));
+    fprintf(record_fp, "%s %d\ndate %s\ntime %d\n",
+            SESSION_MAGIC, SESSION_VERSION, date_str, timer_seconds(&game->timer));
+    
+    int lines, cols;
+    screen_get_size(&lines, &cols);
+    fprintf(record_fp, "size %d %d\n", lines, cols);
+    fprintf(record_fp, "set auto_advance %d\nset auto_mark %d\n"
+                       "set max_fps %d\nset compact %d\n",
+            g_config.auto_advance, g_config.auto_mark,
+            g_config.max_fps, g_config.compact);
+    
+    GameState *state = game->state;
+    if (state->exists && state->chars_json) {
+        fprintf(record_fp, "chars ");
+        write_hex(state->chars_json, strlen(state->chars_json));
+    }
+    
+    record_start = clock_now_us();
+    screen_set_key_observer(record_key);
+    return true;
+}
+
+void session_record_stop(void) {
+    if (!record_fp) return;
+    screen_set_key_observer(NULL);
+    fclose(record_fp);
+    record_fp = NULL;
+}
+
+// Replay
+
+// Where a recorded session started
+typedef struct {
+    Date date;
+    int time;
+    int lines;          // Terminal size, 0 if not recorded
+    int cols;
+    char *chars;        // Saved board, if there was one
+} SessionHeader;
+
+static SessionHeader header;
+static SessionEvent *events;
+static int event_count;
+static int event_next;
+static bool replay_realtime;
+static unsigned long long replay_real_start;
+
+static int hex_value(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Hex up to the end of the line, as text NUL-terminated after len bytes
+static bool read_hex(FILE *fp, char **text, size_t *len) {
+    size_t cap = 64;
+    *text = malloc(cap);
+    *len = 0;
+    
+    int c;
+    while ((c = fgetc(fp)) == ' ') {}
+    while (c != EOF && c != '\n') {
+        int hi = hex_value(c);
+        int lo = hex_value(fgetc(fp));
+        if (hi < 0 || lo < 0) return false;
+        if (*len + 1 == cap) {
+            cap *= 2;
+            *text = realloc(*text, cap);
+        }
+        (*text)[(*len)++] = (char)(hi << 4 | lo);
+        c = fgetc(fp);
+    }
+    (*text)[*len] = '\0';
+    return true;
+}
+
+static void session_free(void) {
+    for (int i = 0; i < event_count; i++) {
+        free(events[i].text);
+    }
+    free(events);
+    events = NULL;
+    event_count = event_next = 0;
+    free(header.chars);
+    memset(&header, 0, sizeof(header));
+}
+
+// Read a session into header and events. Its settings are applied to
+// g_config as they are read.
+static bool session_load(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return false;
+    
+    // Version 1 sessions have none of the lines after time
+    int version = 0;
+    char magic[32];
+    bool ok = fscanf(fp, "%31s %d", magic, &version) == 2 &&
+              strcmp(magic, SESSION_MAGIC) == 0 &&
+              version >= 1 && version <= SESSION_VERSION &&
+              fscanf(fp, " date %d-%d-%d", &header.date.year,
+                     &header.date.month, &header.date.day) == 3 &&
+              fscanf(fp, " time %d", &header.time) == 1;
+    
+    // The rest of the header, up to the first event's time
+    while (ok) {
+        int c;
+        while ((c = fgetc(fp)) == ' ' || c == '\n') {}
+        ungetc(c, fp);
+        if (c == EOF || (c >= '0' && c <= '9')) break;
+        
+        char word[16];
+        if (fscanf(fp, "%15s", word) != 1) {
+            ok = false;
+        } else if (strcmp(word, "size") == 0) {
+            ok = fscanf(fp, "%d %d", &header.lines, &header.cols) == 2;
+        } else if (strcmp(word, "set") == 0) {
+            char key[32];
+            int value;
+            ok = fscanf(fp, "%31s %d", key, &value) == 2;
+            if (ok) config_parse_setting(key, value);
+        } else if (strcmp(word, "chars") == 0 && !header.chars) {
+            size_t len;
+            ok = read_hex(fp, &header.chars, &len);
+        } else {
+            ok = false;
+        }
+    }
+    
+    int cap = 0;
+    while (ok) {
+        unsigned long long at;
+        char kind[8];
+        if (fscanf(fp, " %llu %7s", &at, kind) != 2) break;
+        
+        if (event_count == cap) {
+            cap = cap ? cap * 2 : 256;
+            events = realloc(events, cap * sizeof(SessionEvent));
+        }
+        SessionEvent *ev = &events[event_count];
+        memset(ev, 0, sizeof(*ev));
+        ev->at = at;
+        
+        if (strcmp(kind, "key") == 0) {
+            ok = fscanf(fp, "%d", &ev->key) == 1;
+        } else if (strcmp(kind, "paste") == 0) {
+            ev->key = KEY_PASTE;
+            ok = read_hex(fp, &ev->text, &ev->text_len);
+        } else {
+            ok = false;
+        }
+        event_count++;
+    }
+    
+    fclose(fp);
+    if (!ok) session_free();
+    return ok;
+}
+
+static void replay_sleep_us(unsigned long long us) {
+#ifdef _WIN32
+    Sleep((DWORD)(us / 1000));
+#else
+    struct timespec ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+    nanosleep(&ts, NULL);
+#endif
+}
+
+// Move the virtual clock to at, first waiting out the gap in real time
+// if the replay is paced
+static void replay_advance(unsigned long long at) {
+    if (replay_realtime) {
+        unsigned long long due = replay_real_start + (at - SESSION_CLOCK_BASE);
+        unsigned long long now = clock_real_us();
+        if (due > now) replay_sleep_us(due - now);
+    }
+    clock_set_virtual(at);
+}
+
+// The replay backend draws like the headless one and reads keys from the
+// session. A wait that would end before the next key moves the clock to
+// its end and times out, so deadlines fire when they did live.
+static bool replay_init(void) {
+    return backend_headless.init();
+}
+
+static void replay_shutdown(void) {
+    backend_headless.shutdown();
+}
+
+static void replay_get_size(int *lines, int *cols) {
+    backend_headless.get_size(lines, cols);
+}
+
+static void replay_write(const char *buf, size_t len) {
+    backend_headless.write(buf, len);
+}
+
+static int replay_read_key(int timeout_ms) {
+    InputEvent next;
+    if (input_next(&next)) return next.key;
+    
+    // End of the session reads as Ctrl+C, like the end of headless input
+    if (event_next >= event_count) return 3;
+    
+    SessionEvent *ev = &events[event_next];
+    unsigned long long at = SESSION_CLOCK_BASE + ev->at;
+    unsigned long long now = clock_now_us();
+    
+    if (timeout_ms >= 0 && now + (unsigned long long)timeout_ms * 1000 < at) {
+        replay_advance(now + (unsigned long long)timeout_ms * 1000);
+        return BACKEND_TIMEOUT;
+    }
+    replay_advance(at > now ? at : now);
+    event_next++;
+    
+    // Pastes go through the decoder so the game reads them as it did live
+    if (ev->key == KEY_PASTE) {
+        static const char start[] = "\x1b[200~";
+        static const char end[] = "\x1b[201~";
+        input_feed(start, sizeof(start) - 1);
+        input_feed(ev->text, ev->text_len);
+        input_feed(end, sizeof(end) - 1);
+    } else {
+        input_push(ev->key);
+    }
+    return input_next(&next) ? next.key : BACKEND_TIMEOUT;
+}
+
+const ScreenBackend backend_replay = {
+    "replay",
+    replay_init,
+    replay_shutdown,
+    replay_get_size,
+    replay_write,
+    replay_read_key,
+    NULL
+};
+
+int session_replay(const char *path, bool realtime) {
+    // Recorded settings go over the defaults, not the user's own
+    config_default_set();
+    if (!session_load(path)) {
+        printf("Cannot read session: %s\n", path);
+        session_free();
+        return 1;
+    }
+    
+    // The puzzle comes from the local cache, or is fetched as usual
+    if (!db_init()) {
+        printf("Failed to initialize database\n");
+        session_free();
+        return 1;
+    }
+    Puzzle *puzzle = puzzle_new(header.date);
+    if (!puzzle) {
+        printf("Puzzle not available\n");
+        db_close();
+        session_free();
+        return 1;
+    }
+    
+    // Start from the recorded state; the game takes the saved board
+    GameState *state = calloc(1, sizeof(GameState));
+    state->date = header.date;
+    state->time = header.time;
+    state->chars_json = header.chars;
+    state->exists = header.chars != NULL;
+    header.chars = NULL;
+    
+    clock_set_virtual(SESSION_CLOCK_BASE);
+    replay_realtime = realtime;
+    replay_real_start = clock_real_us();
+    
+    headless_set_size(header.lines, header.cols);
+    screen_select_backend(backend_replay.name);
+    screen_setup();
+    screen_reset_stats();
+    
+    Game *game = game_new_with(header.date, puzzle, state);
+    game->persist = false;
+    game_play(game);
+    
+    unsigned long long wall_us = clock_real_us() - replay_real_start;
+    unsigned long long session_us = clock_now_us() - SESSION_CLOCK_BASE;
+    ScreenStats stats;
+    screen_get_stats(&stats);
+    unsigned long long solve_ms = timer_elapsed_ms(&game->timer);
+    
+    game_free(game);
+    screen_shutdown();
+    headless_set_size(0, 0);
+    db_close();
+    
+    printf("Replayed %d keys: %.3f s of session in %.3f s, "
+           "%lu frames, %llu bytes, timer %.3f s\n",
+           event_count, session_us / 1e6, wall_us / 1e6,
+           stats.frames, stats.bytes, solve_ms / 1e3);
+    session_free();
+    return 0;
+}
@@ -0,0 +1,21 @@
+// session.h - Recorded input sessions and headless replay
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stdbool.h>
+#include "cliptic.h"
+#include "game.h"
+
+#define SESSION_MAGIC "cliptic-session"
+#define SESSION_VERSION 2
+
+// Record the state game starts from, then every key it reads, stamped
+// with its time, until session_record_stop
+bool session_record_start(const char *path, Game *game);
+void session_record_stop(void);
+
+// Play a recorded session back against the headless backend on a virtual
+// clock, as fast as possible or in real time, and print what it cost
+int session_replay(const char *path, bool realtime);
+
+#endif // SESSION_H
@@ -8,6 +8,8 @@
 #include "config.h"
 #include "database.h"
 #include "game.h"
+#include "bench.h"
+#include "session.h"
 
 int terminal_parse_args(int argc, char *argv[]) {
     if (strcmp(argv[1], "today") == 0 || strcmp(argv[1], "-t") == 0) {
@@ -25,9 +27,20 @@ int terminal_parse_args(int argc, char *argv[]) {
             return 1;
         }
     }
+    else if (strcmp(argv[1], "bench") == 0) {
+        return terminal_cmd_bench(argc > 2 ? argv[2] : NULL);
+    }
+    else if (strcmp(argv[1], "record") == 0 && argc > 2) {
+        return terminal_cmd_record(argv[2], argc > 3 ? atoi(argv[3]) : 0);
+    }
+    else if (strcmp(argv[1], "replay") == 0 && argc > 2) {
+        bool realtime = argc > 3 && strcmp(argv[3], "realtime") == 0;
+        return terminal_cmd_replay(argv[2], realtime);
+    }
     else {
         printf("Unknown command: %s\n", argv[1]);
-        printf("Usage: cliptic [today [-n]|reset <what>]\n");
+        printf("Usage: cliptic [today [-n]|reset <what>|bench [out.json]|\n"
+               "               record <file> [-n]|replay <file> [realtime]]\n");
         return 1;
     }
 }
@@ -56,6 +69,33 @@ int terminal_cmd_today(int offset) {
     return 0;
 }
 
+// Play today's puzzle like terminal_cmd_today, recording the session
+int terminal_cmd_record(const char *path, int offset) {
+    config_default_set();
+    screen_setup();
+    config_custom_set();
+    atexit(terminal_cleanup);
+    
+    if (!db_init()) {
+        printf("Failed to initialize database\n");
+        return 1;
+    }
+    
+    Date date = date_add_days(date_today(), offset);
+    Game *game = game_new(date);
+    if (!game) return 1;
+    
+    if (!session_record_start(path, game)) {
+        game_free(game);
+        return 1;
+    }
+    game_play(game);
+    session_record_stop();
+    game_free(game);
+    
+    return 0;
+}
+
 int terminal_cmd_reset(const char *what) {
     printf("cliptic: Reset %s\n", what);
     printf("Are you sure? This cannot be undone! [Y/n]\n");
@@ -103,11 +143,22 @@ int terminal_cmd_reset(const char *what) {
     return success ? 0 : 1;
 }
 
+int terminal_cmd_bench(const char *out_path) {
+    return bench_run(out_path);
+}
+
+int terminal_cmd_replay(const char *path, bool realtime) {
+    return session_replay(path, realtime);
+}
+
 void terminal_cleanup(void) {
     // Clean up database
     db_close();
     
-    // Clear screen and show message
+    // Clear screen, hand the terminal back and show message
     screen_clear();
+    console_set_cursor_visible(true);
+    screen_present();
+    screen_shutdown();
     printf("Thanks for playing!\n");
 }
\ No newline at end of file
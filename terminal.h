@@ -2,6 +2,8 @@
 #ifndef TERMINAL_H
 #define TERMINAL_H
 
+#include <stdbool.h>
+
 // Terminal functions
 int terminal_parse_args(int argc, char *argv[]);
 void terminal_cleanup(void);
@@ -9,5 +11,8 @@ void terminal_cleanup(void);
 // Command functions
 int terminal_cmd_today(int offset);
 int terminal_cmd_reset(const char *what);
+int terminal_cmd_bench(const char *out_path);
+int terminal_cmd_record(const char *path, int offset);
+int terminal_cmd_replay(const char *path, bool realtime);
 
 #endif // TERMINAL_H
\ No newline at end of file
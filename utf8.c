@@ -0,0 +1,186 @@
+// utf8.c - UTF-8 decoding and display width
+#include <stdint.h>
+#include <string.h>
+#include "utf8.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UTF8_SSE2
+#endif
+
+// Code point ranges, sorted, for the width lookup
+typedef struct {
+    unsigned int first;
+    unsigned int last;
+} Range;
+
+// Combining marks and format characters: no column of their own
+static const Range zero_width[] = {
+    {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x05BF, 0x05BF},
+    {0x05C1, 0x05C2}, {0x05C4, 0x05C5}, {0x05C7, 0x05C7}, {0x0610, 0x061A},
+    {0x064B, 0x065F}, {0x0670, 0x0670}, {0x06D6, 0x06DC}, {0x06DF, 0x06E4},
+    {0x06E7, 0x06E8}, {0x06EA, 0x06ED}, {0x0900, 0x0902}, {0x093A, 0x093A},
+    {0x093C, 0x093C}, {0x0941, 0x0948}, {0x094D, 0x094D}, {0x0951, 0x0957},
+    {0x0E31, 0x0E31}, {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E}, {0x1AB0, 0x1AFF},
+    {0x1DC0, 0x1DFF}, {0x200B, 0x200F}, {0x202A, 0x202E}, {0x2060, 0x2064},
+    {0x20D0, 0x20FF}, {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F}, {0xFEFF, 0xFEFF},
+    {0xE0100, 0xE01EF}
+};
+
+// East Asian wide and fullwidth, plus emoji: two columns
+static const Range double_width[] = {
+    {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC},
+    {0x23F0, 0x23F0}, {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615},
+    {0x2648, 0x2653}, {0x267F, 0x267F}, {0x2693, 0x2693}, {0x26A1, 0x26A1},
+    {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5}, {0x26CE, 0x26CE},
+    {0x26D4, 0x26D4}, {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5},
+    {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B},
+    {0x2728, 0x2728}, {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755},
+    {0x2757, 0x2757}, {0x2795, 0x2797}, {0x27B0, 0x27B0}, {0x27BF, 0x27BF},
+    {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55}, {0x2E80, 0x303E},
+    {0x3041, 0x33FF}, {0x3400, 0x4DBF}, {0x4E00, 0x9FFF}, {0xA000, 0xA4CF},
+    {0xA960, 0xA97F}, {0xAC00, 0xD7A3}, {0xF900, 0xFAFF}, {0xFE10, 0xFE19},
+    {0xFE30, 0xFE6F}, {0xFF00, 0xFF60}, {0xFFE0, 0xFFE6}, {0x1F004, 0x1F004},
+    {0x1F0CF, 0x1F0CF}, {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A}, {0x1F200, 0x1F251},
+    {0x1F300, 0x1F64F}, {0x1F680, 0x1F6FF}, {0x1F7E0, 0x1F7EB}, {0x1F900, 0x1F9FF},
+    {0x1FA70, 0x1FAFF}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}
+};
+
+static int in_table(unsigned int cp, const Range *table, int count) {
+    int lo = 0, hi = count - 1;
+    if (cp < table[0].first || cp > table[hi].last) return 0;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (cp > table[mid].last) {
+            lo = mid + 1;
+        } else if (cp < table[mid].first) {
+            hi = mid - 1;
+        } else {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Columns taken by one code point: 0, 1 or 2. Control characters count
+// as zero since nothing visible is drawn for them.
+int utf8_cp_width(unsigned int cp) {
+    if (cp < 0x20 || (cp >= 0x7F && cp < 0xA0)) return 0;
+    if (cp < 0x300) return 1;
+    if (in_table(cp, zero_width, sizeof(zero_width) / sizeof(zero_width[0]))) return 0;
+    if (in_table(cp, double_width, sizeof(double_width) / sizeof(double_width[0]))) return 2;
+    return 1;
+}
+
+// Decode the code point at s into cp and return the bytes it used.
+// Malformed, overlong and surrogate sequences decode to U+FFFD and
+// consume one byte, so a bad byte never swallows the text after it.
+size_t utf8_decode(const char *s, size_t len, unsigned int *cp) {
+    const unsigned char *p = (const unsigned char *)s;
+    unsigned int c = p[0];
+    size_t n;
+    unsigned int min;
+    
+    if (c < 0x80) {
+        *cp = c;
+        return 1;
+    } else if (c >= 0xC2 && c <= 0xDF) {
+        n = 2; min = 0x80; c &= 0x1F;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        n = 3; min = 0x800; c &= 0x0F;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        n = 4; min = 0x10000; c &= 0x07;
+    } else {
+        *cp = UTF8_REPLACEMENT;
+        return 1;
+    }
+    
+    if (n > len) {
+        *cp = UTF8_REPLACEMENT;
+        return 1;
+    }
+    for (size_t i = 1; i < n; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            *cp = UTF8_REPLACEMENT;
+            return 1;
+        }
+        c = (c << 6) | (p[i] & 0x3F);
+    }
+    if (c < min || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+        *cp = UTF8_REPLACEMENT;
+        return 1;
+    }
+    
+    *cp = c;
+    return n;
+}
+
+// Encode cp into buf (at least 4 bytes) and return the length
+int utf8_encode(unsigned int cp, char *buf) {
+    if (cp < 0x80) {
+        buf[0] = (char)cp;
+        return 1;
+    } else if (cp < 0x800) {
+        buf[0] = (char)(0xC0 | (cp >> 6));
+        buf[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    } else if (cp < 0x10000) {
+        buf[0] = (char)(0xE0 | (cp >> 12));
+        buf[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        buf[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    } else if (cp <= 0x10FFFF) {
+        buf[0] = (char)(0xF0 | (cp >> 18));
+        buf[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        buf[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        buf[3] = (char)(0x80 | (cp & 0x3F));
+        return 4;
+    }
+    return utf8_encode(UTF8_REPLACEMENT, buf);
+}
+
+// Length of the leading run of ASCII bytes. Sixteen bytes are checked
+// per step with SSE2 where available, eight per step otherwise; only
+// the tail of the run is walked a byte at a time.
+size_t utf8_ascii_run(const char *s, size_t len) {
+    size_t i = 0;
+    
+#ifdef UTF8_SSE2
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+        if (_mm_movemask_epi8(v)) break;
+    }
+#endif
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, s + i, sizeof(w));
+        if (w & 0x8080808080808080ULL) break;
+    }
+    while (i < len && !((unsigned char)s[i] & 0x80)) i++;
+    
+    return i;
+}
+
+// Columns needed to show len bytes of UTF-8 text. ASCII runs are
+// counted a byte per column without decoding.
+int utf8_width_n(const char *s, size_t len) {
+    int cols = 0;
+    size_t i = 0;
+    
+    while (i < len) {
+        size_t run = utf8_ascii_run(s + i, len - i);
+        cols += (int)run;
+        i += run;
+        if (i >= len) break;
+        
+        unsigned int cp;
+        i += utf8_decode(s + i, len - i, &cp);
+        cols += utf8_cp_width(cp);
+    }
+    
+    return cols;
+}
+
+int utf8_width(const char *s) {
+    return utf8_width_n(s, strlen(s));
+}
@@ -0,0 +1,19 @@
+// utf8.h - UTF-8 decoding and display width
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <stddef.h>
+
+#define UTF8_REPLACEMENT 0xFFFD
+
+// Decoding
+size_t utf8_decode(const char *s, size_t len, unsigned int *cp);
+int utf8_encode(unsigned int cp, char *buf);
+size_t utf8_ascii_run(const char *s, size_t len);
+
+// Display width in terminal columns
+int utf8_cp_width(unsigned int cp);
+int utf8_width(const char *s);
+int utf8_width_n(const char *s, size_t len);
+
+#endif // UTF8_H
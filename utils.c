@@ -19,6 +19,42 @@ Direction pos_change_dir(Direction dir) {
     return (dir == DIR_ACROSS) ? DIR_DOWN : DIR_ACROSS;
 }
 
+// Clock functions
+//
+// clock_now_us is the clock everything in the game runs on: deadlines,
+// the solve timer and frame pacing. A session replay swaps it for a
+// virtual clock it advances itself; clock_real_us always reads the
+// monotonic clock.
+static bool clock_virtual;
+static unsigned long long clock_virtual_us;
+
+unsigned long long clock_now_us(void) {
+    if (clock_virtual) return clock_virtual_us;
+    return clock_real_us();
+}
+
+// Switch to the virtual clock and set it; it only ever moves forward
+void clock_set_virtual(unsigned long long now_us) {
+    if (clock_virtual && now_us < clock_virtual_us) return;
+    clock_virtual = true;
+    clock_virtual_us = now_us;
+}
+
+unsigned long long clock_real_us(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (unsigned long long)(now.QuadPart / freq.QuadPart) * 1000000ULL +
+           (unsigned long long)(now.QuadPart % freq.QuadPart) * 1000000ULL / freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+#endif
+}
+
 // Date functions
 Date date_today(void) {
     time_t t = time(NULL);
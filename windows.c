@@ -6,6 +6,7 @@
 #include "windows.h"
 #include "screen.h"
 #include "config.h"
+#include "utf8.h"
 
 // Window functions
 void window_init(Window *win, int y, int x, int line, int col) {
@@ -75,46 +76,26 @@ void window_clear(Window *win) {
 
 void window_add_str(Window *win, int y, int x, const char *str) {
     console_move_cursor(win->line + y, win->col + x);
-    
-    wchar_t wstr[256];
-    mbstowcs(wstr, str, 256);
-    console_write_string(wstr);
+    console_write_utf8(str);
 }
 
 void window_add_str_centered(Window *win, int y, const char *str) {
-    int x = (win->x - strlen(str)) / 2;
+    int x = (win->x - utf8_width(str)) / 2;
     window_add_str(win, y, x, str);
 }
 
 void window_wrap_str(Window *win, int start_line, const char *str) {
-    int max_width = win->x - 4;
-    int len = strlen(str);
-    int line = start_line;
-    int pos = 0;
-    
-    while (pos < len && line < win->y - 1) {
-        int line_end = pos + max_width;
-        if (line_end > len) line_end = len;
-        
-        // Find last space before line_end
-        int space_pos = line_end;
-        while (space_pos > pos && str[space_pos] != ' ') {
-            space_pos--;
-        }
-        
-        if (space_pos > pos) {
-            line_end = space_pos;
-        }
-        
-        // Print the line
-        console_move_cursor(win->line + line, win->col + 2);
-        for (int i = pos; i < line_end; i++) {
-            console_write_char(str[i]);
-        }
-        
-        pos = line_end;
-        if (pos < len && str[pos] == ' ') pos++;
-        line++;
+    TextLayout layout = {0};
+    layout_wrap(&layout, str, win->x - 4, console_get_color());
+    window_draw_layout(win, start_line, &layout);
+    free(layout.cells);
+}
+
+// Blit prewrapped rows inside the window borders
+void window_draw_layout(Window *win, int start_line, TextLayout *layout) {
+    for (int r = 0; r < layout->rows && start_line + r < win->y - 1; r++) {
+        screen_blit(win->line + start_line + r, win->col + 2,
+                    &layout->cells[r * layout->width], layout->width);
     }
 }
 
@@ -135,14 +116,138 @@ void window_move(Window *win, int line, int col) {
     }
 }
 
+// Text layout functions
+TextLayout* layout_new(void) {
+    return calloc(1, sizeof(TextLayout));
+}
+
+// Wrap UTF-8 text at spaces into rows of width columns. The text is
+// decoded once here; drawing it again is a straight copy of the rows.
+void layout_wrap(TextLayout *layout, const char *str, int width, int color) {
+    free(layout->cells);
+    layout->cells = NULL;
+    layout->rows = 0;
+    layout->width = 0;
+    if (width <= 0) return;
+    
+    // Decode to glyphs with their column widths
+    size_t len = strlen(str);
+    wchar_t *glyphs = malloc((len + 1) * sizeof(wchar_t));
+    unsigned char *cols = malloc(len + 1);
+    if (!glyphs || !cols) {
+        free(glyphs);
+        free(cols);
+        return;
+    }
+    
+    int n = 0;
+    size_t i = 0;
+    while (i < len) {
+        size_t run = utf8_ascii_run(str + i, len - i);
+        for (size_t j = 0; j < run; j++) {
+            if ((unsigned char)str[i + j] < 0x20) continue;
+            glyphs[n] = (wchar_t)str[i + j];
+            cols[n++] = 1;
+        }
+        i += run;
+        if (i >= len) break;
+        
+        unsigned int cp;
+        i += utf8_decode(str + i, len - i, &cp);
+        int w = utf8_cp_width(cp);
+        if (w == 0) continue;
+        if (sizeof(wchar_t) < 4 && cp > 0xFFFF) cp = UTF8_REPLACEMENT;
+        if (w > width) {
+            cp = ' ';
+            w = 1;
+        }
+        glyphs[n] = (wchar_t)cp;
+        cols[n++] = (unsigned char)w;
+    }
+    
+    // Every row holds at least one glyph, so n rows is enough
+    layout->cells = malloc((n > 0 ? n : 1) * width * sizeof(ScreenCell));
+    if (!layout->cells) {
+        free(glyphs);
+        free(cols);
+        return;
+    }
+    
+    int pos = 0;
+    while (pos < n) {
+        // Take glyphs while they fit, then back up to the last space
+        int line_end = pos;
+        int used = 0;
+        while (line_end < n && used + cols[line_end] <= width) {
+            used += cols[line_end++];
+        }
+        if (line_end < n) {
+            int space_pos = line_end;
+            while (space_pos > pos && glyphs[space_pos] != L' ') {
+                space_pos--;
+            }
+            if (space_pos > pos) {
+                line_end = space_pos;
+            }
+        }
+        
+        ScreenCell *row = &layout->cells[layout->rows * width];
+        int x = 0;
+        for (int g = pos; g < line_end; g++) {
+            row[x++].ch = glyphs[g];
+            if (cols[g] == 2) row[x++].ch = SCREEN_WIDE_TAIL;
+        }
+        while (x < width) row[x++].ch = L' ';
+        for (x = 0; x < width; x++) {
+            row[x].color = color;
+            row[x].underline = false;
+        }
+        layout->rows++;
+        
+        pos = line_end;
+        if (pos < n && glyphs[pos] == L' ') pos++;
+    }
+    
+    free(glyphs);
+    free(cols);
+    layout->width = width;
+    layout->color = color;
+}
+
+bool layout_valid(TextLayout *layout, int width, int color) {
+    return layout->width == width && layout->color == color;
+}
+
+void layout_invalidate(TextLayout *layout) {
+    if (layout) layout->width = 0;
+}
+
+void layout_free(TextLayout *layout) {
+    if (layout) {
+        free(layout->cells);
+        free(layout);
+    }
+}
+
 // Grid functions
 Grid* grid_new(int y, int x, int line, int col) {
     Grid *grid = calloc(1, sizeof(Grid));
     grid->sq.y = y;
     grid->sq.x = x;
     
-    // Convert grid squares to window dimensions
-    window_init(&grid->window, (2 * y) + 1, (4 * x) + 1, line, col);
+    // Convert grid squares to window dimensions; everything is visible
+    // until grid_fit narrows the view. Compact squares are two number
+    // columns and a letter column on one row, with no borders.
+    grid->compact = g_config.compact;
+    if (grid->compact) {
+        grid->sq_size = pos_make(1, 3);
+        grid->layer_size = pos_make(y, 3 * x);
+    } else {
+        grid->sq_size = pos_make(2, 4);
+        grid->layer_size = pos_make((2 * y) + 1, (4 * x) + 1);
+    }
+    grid->view_sq = grid->sq;
+    window_init(&grid->window, grid->layer_size.y, grid->layer_size.x, line, col);
     
     // Allocate cells
     grid->cells = calloc(y, sizeof(Cell**));
@@ -153,74 +258,217 @@ Grid* grid_new(int y, int x, int line, int col) {
             grid->cells[i][j]->sq.y = i;
             grid->cells[i][j]->sq.x = j;
             grid->cells[i][j]->grid = grid;
-            grid->cells[i][j]->pos.y = (2 * i) + 1;
-            grid->cells[i][j]->pos.x = (4 * j) + 2;
+            if (grid->compact) {
+                grid->cells[i][j]->pos.y = i;
+                grid->cells[i][j]->pos.x = (3 * j) + 2;
+            } else {
+                grid->cells[i][j]->pos.y = (2 * i) + 1;
+                grid->cells[i][j]->pos.x = (4 * j) + 2;
+            }
             grid->cells[i][j]->buffer = ' ';
+            grid->cells[i][j]->color = g_colors.grid;
         }
     }
+    grid->dirty = calloc(y * x, sizeof(Cell*));
+    grid->dirty_count = 0;
+    
+    grid->layer = calloc(grid->layer_size.y * grid->layer_size.x, sizeof(ScreenCell));
+    grid_bake(grid);
     
     return grid;
 }
 
-void grid_draw(Grid *grid) {
-    console_set_color(g_colors.grid);
+static void layer_put(Grid *grid, int y, int x, wchar_t ch, int color) {
+    ScreenCell *cell = &grid->layer[y * grid->layer_size.x + x];
+    cell->ch = ch;
+    cell->color = color;
+    cell->underline = false;
+}
+
+// Compact layer: a dot marks each open square, blocks fill all three
+// columns and the clue number sits right-aligned left of its letter
+static void grid_bake_compact(Grid *grid) {
+    for (int i = 0; i < grid->sq.y; i++) {
+        for (int j = 0; j < grid->sq.x; j++) {
+            Cell *cell = grid->cells[i][j];
+            int y = cell->pos.y;
+            int x = cell->pos.x;
+            
+            if (cell->blocked) {
+                layer_put(grid, y, x - 2, UC_BLOCK_M, g_colors.block);
+                layer_put(grid, y, x - 1, UC_BLOCK_M, g_colors.block);
+                layer_put(grid, y, x, UC_BLOCK_M, g_colors.block);
+            } else {
+                int n = cell->index;
+                if (n >= 10) {
+                    layer_put(grid, y, x - 2, UC_NUMS[n / 10 % 10], g_colors.num);
+                } else {
+                    layer_put(grid, y, x - 2, L' ', g_colors.grid);
+                }
+                if (n > 0) {
+                    layer_put(grid, y, x - 1, UC_NUMS[n % 10], g_colors.num);
+                } else {
+                    layer_put(grid, y, x - 1, L' ', g_colors.grid);
+                }
+                layer_put(grid, y, x, UC_DOT, g_colors.grid);
+            }
+        }
+    }
+}
+
+// Render the static parts of the grid (borders, blocks and clue numbers)
+// into the layer that grid_draw blits
+void grid_bake(Grid *grid) {
+    if (grid->compact) {
+        grid_bake_compact(grid);
+        return;
+    }
     
-    for (int i = 0; i < grid->window.y; i++) {
-        console_move_cursor(grid->window.line + i, grid->window.col);
+    int w = grid->layer_size.x;
+    
+    for (int i = 0; i < grid->layer_size.y; i++) {
+        wchar_t left, join, right, fill;
         
         if (i == 0) {
             // Top border
-            console_write_char(UC_TL);
-            for (int j = 0; j < grid->sq.x - 1; j++) {
-                console_write_char(UC_HL);
-                console_write_char(UC_HL);
-                console_write_char(UC_HL);
-                console_write_char(UC_TD);
-            }
-            console_write_char(UC_HL);
-            console_write_char(UC_HL);
-            console_write_char(UC_HL);
-            console_write_char(UC_TR);
-        } else if (i == grid->window.y - 1) {
+            left = UC_TL; join = UC_TD; right = UC_TR; fill = UC_HL;
+        } else if (i == grid->layer_size.y - 1) {
             // Bottom border
-            console_write_char(UC_BL);
-            for (int j = 0; j < grid->sq.x - 1; j++) {
-                console_write_char(UC_HL);
-                console_write_char(UC_HL);
-                console_write_char(UC_HL);
-                console_write_char(UC_TU);
-            }
-            console_write_char(UC_HL);
-            console_write_char(UC_HL);
-            console_write_char(UC_HL);
-            console_write_char(UC_BR);
+            left = UC_BL; join = UC_TU; right = UC_BR; fill = UC_HL;
         } else if (i % 2 == 0) {
             // Inner horizontal lines
-            console_write_char(UC_TL_SIDE);
-            for (int j = 0; j < grid->sq.x - 1; j++) {
-                console_write_char(UC_HL);
-                console_write_char(UC_HL);
-                console_write_char(UC_HL);
-                console_write_char(UC_XX);
-            }
-            console_write_char(UC_HL);
-            console_write_char(UC_HL);
-            console_write_char(UC_HL);
-            console_write_char(UC_TR_SIDE);
+            left = UC_TL_SIDE; join = UC_XX; right = UC_TR_SIDE; fill = UC_HL;
         } else {
             // Cell rows
-            for (int j = 0; j <= grid->sq.x; j++) {
-                console_write_char(UC_VL);
-                if (j < grid->sq.x) {
-                    console_write_char(L' ');
-                    console_write_char(L' ');
-                    console_write_char(L' ');
-                }
+            left = UC_VL; join = UC_VL; right = UC_VL; fill = L' ';
+        }
+        
+        for (int j = 0; j < w; j++) {
+            wchar_t ch = fill;
+            if (j == 0) ch = left;
+            else if (j == w - 1) ch = right;
+            else if (j % 4 == 0) ch = join;
+            layer_put(grid, i, j, ch, g_colors.grid);
+        }
+    }
+    
+    for (int i = 0; i < grid->sq.y; i++) {
+        for (int j = 0; j < grid->sq.x; j++) {
+            Cell *cell = grid->cells[i][j];
+            
+            if (cell->blocked) {
+                layer_put(grid, cell->pos.y, cell->pos.x - 1, UC_BLOCK_L, g_colors.block);
+                layer_put(grid, cell->pos.y, cell->pos.x, UC_BLOCK_M, g_colors.block);
+                layer_put(grid, cell->pos.y, cell->pos.x + 1, UC_BLOCK_R, g_colors.block);
+            }
+            
+            int n = cell->index;
+            if (n >= 10) {
+                layer_put(grid, cell->pos.y - 1, cell->pos.x - 1, UC_NUMS[n / 10], g_colors.num);
+                layer_put(grid, cell->pos.y - 1, cell->pos.x, UC_NUMS[n % 10], g_colors.num);
+            } else if (n > 0) {
+                layer_put(grid, cell->pos.y - 1, cell->pos.x - 1, UC_NUMS[n], g_colors.num);
             }
         }
     }
 }
 
+// Blit the visible part of the static layer, then queue the cells whose
+// dynamic state (letters, marks, highlights) has to be painted over it
+void grid_draw(Grid *grid) {
+    int top = grid->sq_size.y * grid->view.y;
+    int left = grid->sq_size.x * grid->view.x;
+    for (int i = 0; i < grid->window.y; i++) {
+        screen_blit(grid->window.line + i, grid->window.col,
+                    &grid->layer[(top + i) * grid->layer_size.x + left],
+                    grid->window.x);
+    }
+    grid_touch_overlay(grid);
+}
+
+// Size the view to what fits in lines x cols, shrinking the window to
+// match, and keep the first visible square in range
+void grid_fit(Grid *grid, int lines, int cols) {
+    int border = grid->compact ? 0 : 1;
+    grid->view_sq.y = (lines - border) / grid->sq_size.y;
+    grid->view_sq.x = (cols - border) / grid->sq_size.x;
+    if (grid->view_sq.y > grid->sq.y) grid->view_sq.y = grid->sq.y;
+    if (grid->view_sq.x > grid->sq.x) grid->view_sq.x = grid->sq.x;
+    if (grid->view_sq.y < 1) grid->view_sq.y = 1;
+    if (grid->view_sq.x < 1) grid->view_sq.x = 1;
+    
+    window_init(&grid->window,
+                (grid->sq_size.y * grid->view_sq.y) + border,
+                (grid->sq_size.x * grid->view_sq.x) + border,
+                grid->window.line, grid->window.centered_x ? -1 : grid->window.col);
+    
+    if (grid->view.y > grid->sq.y - grid->view_sq.y) grid->view.y = grid->sq.y - grid->view_sq.y;
+    if (grid->view.x > grid->sq.x - grid->view_sq.x) grid->view.x = grid->sq.x - grid->view_sq.x;
+}
+
+// Squares kept between the cursor and the edge of the view
+#define GRID_SCROLL_MARGIN 1
+
+static int view_axis(int first, int pos, int visible, int total) {
+    int margin = visible > 2 * GRID_SCROLL_MARGIN ? GRID_SCROLL_MARGIN : 0;
+    if (pos - margin < first) first = pos - margin;
+    if (pos + margin >= first + visible) first = pos + margin - visible + 1;
+    if (first > total - visible) first = total - visible;
+    if (first < 0) first = 0;
+    return first;
+}
+
+// Scroll so square (y, x) is in view. Returns true if the view moved,
+// in which case the caller has to grid_draw again.
+bool grid_follow(Grid *grid, int y, int x) {
+    int vy = view_axis(grid->view.y, y, grid->view_sq.y, grid->sq.y);
+    int vx = view_axis(grid->view.x, x, grid->view_sq.x, grid->sq.x);
+    if (vy == grid->view.y && vx == grid->view.x) return false;
+    
+    grid->view.y = vy;
+    grid->view.x = vx;
+    return true;
+}
+
+static bool cell_visible(Cell *cell) {
+    Grid *grid = cell->grid;
+    return cell->sq.y >= grid->view.y && cell->sq.y < grid->view.y + grid->view_sq.y &&
+           cell->sq.x >= grid->view.x && cell->sq.x < grid->view.x + grid->view_sq.x;
+}
+
+// Write out every cell changed since the last flush
+void grid_flush(Grid *grid) {
+    for (int i = 0; i < grid->dirty_count; i++) {
+        cell_flush(grid->dirty[i]);
+    }
+    grid->dirty_count = 0;
+}
+
+// Queue every visible cell that differs from the static layer. Cells
+// out of view are never queued, so only queued cells can be dirty.
+void grid_touch_overlay(Grid *grid) {
+    for (int i = 0; i < grid->dirty_count; i++) {
+        grid->dirty[i]->dirty = 0;
+    }
+    grid->dirty_count = 0;
+    
+    int bottom = grid->view.y + grid->view_sq.y;
+    int right = grid->view.x + grid->view_sq.x;
+    for (int i = grid->view.y; i < bottom; i++) {
+        for (int j = grid->view.x; j < right; j++) {
+            Cell *cell = grid->cells[i][j];
+            if (cell->blocked) continue;
+            
+            if (cell->num_active) cell->dirty |= CELL_DIRTY_NUMBER;
+            if (cell->buffer != ' ') cell->dirty |= CELL_DIRTY_LETTER;
+            if (cell->underlined) cell->dirty |= CELL_DIRTY_UNDERLINE;
+            if (cell->color != g_colors.grid) cell->dirty |= CELL_DIRTY_COLOR;
+            
+            if (cell->dirty) grid->dirty[grid->dirty_count++] = cell;
+        }
+    }
+}
+
 Cell* grid_get_cell(Grid *grid, int y, int x) {
     if (y >= 0 && y < grid->sq.y && x >= 0 && x < grid->sq.x) {
         return grid->cells[y][x];
@@ -237,67 +485,119 @@ void grid_free(Grid *grid) {
             free(grid->cells[i]);
         }
         free(grid->cells);
+        free(grid->dirty);
+        free(grid->layer);
         free(grid);
     }
 }
 
 // Cell functions
 void cell_focus(Cell *cell, int y_offset, int x_offset) {
+    Grid *grid = cell->grid;
     console_move_cursor(
-        cell->grid->window.line + cell->pos.y + y_offset,
-        cell->grid->window.col + cell->pos.x + x_offset
+        grid->window.line + cell->pos.y - (grid->sq_size.y * grid->view.y) + y_offset,
+        grid->window.col + cell->pos.x - (grid->sq_size.x * grid->view.x) + x_offset
     );
 }
 
+// Queue a visible cell for the next flush. Cells out of view only keep
+// their state; grid_draw picks them up when they scroll in.
+static void cell_mark_dirty(Cell *cell, unsigned char flags) {
+    if (!cell_visible(cell)) return;
+    if (!cell->dirty) {
+        cell->grid->dirty[cell->grid->dirty_count++] = cell;
+    }
+    cell->dirty |= flags;
+}
+
 void cell_set_number(Cell *cell, int n, bool active) {
-    if (!cell->index) cell->index = n;
-    
-    console_set_color(active ? g_colors.active_num : g_colors.num);
-    cell_focus(cell, -1, -1);
-    
-    // Write small number
-    if (n < 10) {
-        console_write_char(UC_NUMS[n]);
-    } else {
-        console_write_char(UC_NUMS[n / 10]);
-        console_write_char(UC_NUMS[n % 10]);
+    if (!cell->index) {
+        cell->index = n;
+        cell_mark_dirty(cell, CELL_DIRTY_NUMBER);
+    }
+    if (cell->num_active != active) {
+        cell->num_active = active;
+        cell_mark_dirty(cell, CELL_DIRTY_NUMBER);
     }
-    
-    console_set_color(g_colors.grid);
 }
 
 void cell_set_block(Cell *cell) {
     cell->blocked = true;
-    console_set_color(g_colors.block);
-    cell_focus(cell, 0, -1);
-    console_write_char(UC_BLOCK_L);
-    console_write_char(UC_BLOCK_M);
-    console_write_char(UC_BLOCK_R);
-    console_set_color(g_colors.grid);
+    cell_mark_dirty(cell, CELL_DIRTY_LETTER);
 }
 
 void cell_write(Cell *cell, char ch) {
-    if (!cell->locked) {
+    if (!cell->locked && cell->buffer != ch) {
         cell->buffer = ch;
-        cell_focus(cell, 0, 0);
-        console_write_char(ch);
+        cell_mark_dirty(cell, CELL_DIRTY_LETTER);
     }
 }
 
-void cell_underline(Cell *cell) {
-    // Windows console doesn't support underline well, so we'll use a different approach
-    // Could use background color or other visual indicator
-    cell_write(cell, cell->buffer);
+void cell_underline(Cell *cell, bool underline) {
+    if (cell->underlined != underline) {
+        cell->underlined = underline;
+        cell_mark_dirty(cell, CELL_DIRTY_UNDERLINE);
+    }
 }
 
 void cell_color(Cell *cell, int color_pair) {
-    console_set_color(color_pair);
-    cell_write(cell, cell->buffer);
-    console_set_color(g_colors.grid);
+    if (cell->color != color_pair) {
+        cell->color = color_pair;
+        cell_mark_dirty(cell, CELL_DIRTY_COLOR);
+    }
 }
 
 void cell_clear(Cell *cell) {
     cell->locked = false;
     cell->blocked = false;
     cell->buffer = ' ';
-}
\ No newline at end of file
+    cell->color = g_colors.grid;
+    cell_mark_dirty(cell, CELL_DIRTY_LETTER | CELL_DIRTY_COLOR);
+}
+
+// Draw whatever parts of the cell are marked dirty
+void cell_flush(Cell *cell) {
+    bool compact = cell->grid->compact;
+    
+    if (cell->dirty & CELL_DIRTY_NUMBER && cell->index) {
+        int n = cell->index;
+        console_set_color(cell->num_active ? g_colors.active_num : g_colors.num);
+        cell_focus(cell, compact ? 0 : -1, compact ? -2 : -1);
+        
+        // Write small number; compact squares right-align it in the two
+        // columns before the letter
+        if (compact) {
+            console_write_char(n < 10 ? L' ' : UC_NUMS[n / 10 % 10]);
+            console_write_char(UC_NUMS[n % 10]);
+        } else if (n < 10) {
+            console_write_char(UC_NUMS[n]);
+        } else {
+            console_write_char(UC_NUMS[n / 10]);
+            console_write_char(UC_NUMS[n % 10]);
+        }
+    }
+    
+    if (cell->blocked) {
+        if (cell->dirty & CELL_DIRTY_LETTER) {
+            console_set_color(g_colors.block);
+            cell_focus(cell, 0, compact ? -2 : -1);
+            if (compact) {
+                console_write_char(UC_BLOCK_M);
+                console_write_char(UC_BLOCK_M);
+                console_write_char(UC_BLOCK_M);
+            } else {
+                console_write_char(UC_BLOCK_L);
+                console_write_char(UC_BLOCK_M);
+                console_write_char(UC_BLOCK_R);
+            }
+        }
+    } else if (cell->dirty & (CELL_DIRTY_LETTER | CELL_DIRTY_COLOR | CELL_DIRTY_UNDERLINE)) {
+        console_set_color(cell->color);
+        console_set_underline(cell->underlined);
+        cell_focus(cell, 0, 0);
+        console_write_char(compact && cell->buffer == ' ' ? UC_DOT : (wchar_t)cell->buffer);
+        console_set_underline(false);
+    }
+    
+    cell->dirty = 0;
+}
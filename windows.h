@@ -4,6 +4,7 @@
 
 #include <stdbool.h>
 #include "cliptic.h"
+#include "screen.h"
 
 // Window structure
 typedef struct {
@@ -20,8 +21,31 @@ typedef struct {
     Window window;
     Position sq;     // Grid squares (y x x)
     struct Cell ***cells;
+    struct Cell **dirty;  // Cells waiting for grid_flush
+    int dirty_count;
+    ScreenCell *layer;    // Borders, blocks and numbers, one row per line
+    bool compact;         // Squares drawn without borders
+    Position sq_size;     // Lines and columns per square
+    Position layer_size;  // Lines and columns of the whole layer
+    Position view;        // First visible square
+    Position view_sq;     // Squares visible at once
 } Grid;
 
+// Wrapped text, kept ready to blit for one wrap width
+typedef struct {
+    int width;        // Wrap width the rows were built for, 0 if stale
+    int color;        // Color pair baked into the cells
+    int rows;
+    ScreenCell *cells; // rows * width cells, padded with spaces
+} TextLayout;
+
+// Cell dirty flags
+#define CELL_DIRTY_LETTER    0x01
+#define CELL_DIRTY_COLOR     0x02
+#define CELL_DIRTY_UNDERLINE 0x04
+#define CELL_DIRTY_NUMBER    0x08
+#define CELL_DIRTY_ALL       0x0F
+
 // Cell structure
 typedef struct Cell {
     Position sq;
@@ -31,6 +55,10 @@ typedef struct Cell {
     bool blocked;
     bool locked;
     char buffer;
+    int color;       // Letter color pair
+    bool underlined; // Part of the active clue
+    bool num_active; // Number drawn highlighted
+    unsigned char dirty;
 } Cell;
 
 // Window functions
@@ -44,10 +72,23 @@ void window_add_str(Window *win, int y, int x, const char *str);
 void window_add_str_centered(Window *win, int y, const char *str);
 void window_wrap_str(Window *win, int start_line, const char *str);
 void window_move(Window *win, int line, int col);
+void window_draw_layout(Window *win, int start_line, TextLayout *layout);
+
+// Text layout functions
+TextLayout* layout_new(void);
+void layout_wrap(TextLayout *layout, const char *str, int width, int color);
+bool layout_valid(TextLayout *layout, int width, int color);
+void layout_invalidate(TextLayout *layout);
+void layout_free(TextLayout *layout);
 
 // Grid functions
 Grid* grid_new(int y, int x, int line, int col);
+void grid_bake(Grid *grid);
 void grid_draw(Grid *grid);
+void grid_fit(Grid *grid, int lines, int cols);
+bool grid_follow(Grid *grid, int y, int x);
+void grid_flush(Grid *grid);
+void grid_touch_overlay(Grid *grid);
 Cell* grid_get_cell(Grid *grid, int y, int x);
 void grid_free(Grid *grid);
 
@@ -55,9 +96,10 @@ void grid_free(Grid *grid);
 void cell_set_number(Cell *cell, int n, bool active);
 void cell_set_block(Cell *cell);
 void cell_write(Cell *cell, char ch);
-void cell_underline(Cell *cell);
+void cell_underline(Cell *cell, bool underline);
 void cell_color(Cell *cell, int color_pair);
 void cell_clear(Cell *cell);
 void cell_focus(Cell *cell, int y_offset, int x_offset);
+void cell_flush(Cell *cell);
 
 #endif // WINDOWS_H_CLIPTIC
\ No newline at end of file